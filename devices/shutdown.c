@@ -8,10 +8,16 @@
 #include "threads/thread.h"
 #ifdef USERPROG
 #include "userprog/exception.h"
+#include "userprog/pagedir.h"
+#include "userprog/syscall.h"
 #endif
 #ifdef FILESYS
 #include "devices/block.h"
 #include "filesys/filesys.h"
+#include "filesys/journal.h"
+#endif
+#ifdef VM
+#include "vm/share.h"
 #endif
 
 /* Keyboard control register port. */
@@ -129,10 +135,16 @@ print_stats (void)
   thread_print_stats ();
 #ifdef FILESYS
   block_print_stats ();
+  journal_print_stats ();
 #endif
   console_print_stats ();
   kbd_print_stats ();
 #ifdef USERPROG
   exception_print_stats ();
+  pagedir_print_stats ();
+  syscall_print_stats ();
+#endif
+#ifdef VM
+  share_print_stats ();
 #endif
 }
@@ -0,0 +1,67 @@
+/* appendbench.c
+
+   Sequential append benchmark.  Creates an empty file and
+   appends to it in 512-byte writes until it is SIZE kB long
+   (default 256), then prints the average cycles per kB
+   written.
+
+   Usage: appendbench [SIZE] */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <syscall.h>
+
+#define FILE_NAME "appendbench.dat"
+#define BLOCK_SIZE 512
+
+static char buf[BLOCK_SIZE];
+
+/* Returns the CPU's time-stamp counter. */
+static uint64_t
+rdtsc (void)
+{
+  uint64_t tsc;
+  asm volatile ("rdtsc" : "=A" (tsc));
+  return tsc;
+}
+
+int
+main (int argc, char *argv[])
+{
+  int kb = 256;
+  uint64_t start, cycles;
+  int fd, i;
+
+  if (argc == 2)
+    kb = atoi (argv[1]);
+  if (argc > 2 || kb <= 0)
+    {
+      printf ("usage: appendbench [SIZE]\n");
+      return EXIT_FAILURE;
+    }
+
+  remove (FILE_NAME);
+  if (!create (FILE_NAME, 0) || (fd = open (FILE_NAME)) < 0)
+    {
+      printf ("appendbench: can't create %s\n", FILE_NAME);
+      return EXIT_FAILURE;
+    }
+  memset (buf, 'a', sizeof buf);
+
+  start = rdtsc ();
+  for (i = 0; i < kb * 1024 / BLOCK_SIZE; i++)
+    if (write (fd, buf, BLOCK_SIZE) != BLOCK_SIZE)
+      {
+        printf ("appendbench: write %d failed\n", i);
+        return EXIT_FAILURE;
+      }
+  cycles = rdtsc () - start;
+
+  close (fd);
+  remove (FILE_NAME);
+  printf ("appendbench: %d kB appended, %llu cycles per kB\n",
+          kb, cycles / kb);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,47 @@
+/* defrag.c
+
+   Runs a pass of the file system's defragmenter and waits for it
+   to finish, then prints how many files and sectors it moved and
+   how fragmented free space is before and after.  With "-n",
+   only prints the current statistics. */
+
+#include <stdio.h>
+#include <string.h>
+#include <syscall.h>
+
+/* Prints the free space part of ST, labeled with WHEN. */
+static void
+print_free (const char *when, const struct defrag_stats *st)
+{
+  printf ("%s: %u free runs, longest %u sectors\n",
+          when, st->free_runs, st->free_largest);
+}
+
+int
+main (int argc, char *argv[])
+{
+  struct defrag_stats before, after;
+
+  if (argc > 2 || (argc == 2 && strcmp (argv[1], "-n")))
+    {
+      printf ("usage: defrag [-n]\n");
+      return EXIT_FAILURE;
+    }
+
+  defrag (0, &before);
+  print_free ("before", &before);
+  if (argc == 2)
+    {
+      printf ("%u passes, %u files and %u sectors moved%s\n",
+              before.passes, before.files_moved, before.sectors_moved,
+              before.running ? ", running" : "");
+      return EXIT_SUCCESS;
+    }
+
+  defrag (DEFRAG_START | DEFRAG_WAIT, &after);
+  print_free ("after", &after);
+  printf ("moved %u files, %u sectors\n",
+          after.files_moved - before.files_moved,
+          after.sectors_moved - before.sectors_moved);
+  return EXIT_SUCCESS;
+}
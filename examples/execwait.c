@@ -0,0 +1,61 @@
+/* execwait.c
+
+   Measures the cost of an exec/wait round trip by running a child
+   process that exits at once and waiting for it, over and over.
+   Each round is dominated by loading and tearing down the child,
+   and includes only a few switches between page directories, so
+   this is not a context switch benchmark.  Prints the average
+   number of CPU cycles per round; compare runs with and without
+   the kernel's -no-pge option, and see the "Paging:" line printed
+   at shutdown for how many CR3 loads were skipped.  The kernel's
+   "cswitch" action times the switches themselves. */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <syscall.h>
+
+/* Returns the CPU's time-stamp counter. */
+static uint64_t
+rdtsc (void)
+{
+  uint64_t tsc;
+  asm volatile ("rdtsc" : "=A" (tsc));
+  return tsc;
+}
+
+int
+main (int argc, char *argv[])
+{
+  uint64_t start, cycles;
+  int rounds = 100;
+  int i;
+
+  /* A child just exits. */
+  if (argc == 2 && argv[1][0] == '-')
+    return 0;
+
+  if (argc == 2)
+    rounds = atoi (argv[1]);
+  if (argc > 2 || rounds <= 0)
+    {
+      printf ("usage: execwait [ROUNDS]\n");
+      return 1;
+    }
+
+  start = rdtsc ();
+  for (i = 0; i < rounds; i++)
+    {
+      pid_t pid = exec ("execwait -");
+      if (pid == PID_ERROR || wait (pid) != 0)
+        {
+          printf ("execwait: child %d failed\n", i);
+          return 1;
+        }
+    }
+  cycles = rdtsc () - start;
+
+  printf ("execwait: %d rounds, %llu cycles per round\n",
+          rounds, cycles / rounds);
+  return 0;
+}
@@ -24,38 +24,44 @@ list_dir (const char *dir, bool verbose)
 
   if (isdir (dir_fd))
     {
-      char name[READDIR_MAX_LEN];
+      struct dirent ents[16];
+      int cnt;
 
       printf ("%s", dir);
       if (verbose)
         printf (" (inumber %d)", inumber (dir_fd));
       printf (":\n");
 
-      while (readdir (dir_fd, name)) 
+      while ((cnt = getdents (dir_fd, ents, sizeof ents)) > 0)
         {
-          printf ("%s", name); 
-          if (verbose) 
-            {
-              char full_name[128];
-              int entry_fd;
+          int i;
 
-              snprintf (full_name, sizeof full_name, "%s/%s", dir, name);
-              entry_fd = open (full_name);
+          for (i = 0; i < cnt; i++)
+            {
+              struct dirent *e = &ents[i];
 
-              printf (": ");
-              if (entry_fd != -1)
+              printf ("%s", e->d_name); 
+              if (verbose) 
                 {
-                  if (isdir (entry_fd))
+                  printf (": ");
+                  if (e->d_isdir)
                     printf ("directory");
                   else
-                    printf ("%d-byte file", filesize (entry_fd));
-                  printf (", inumber %d", inumber (entry_fd));
+                    {
+                      char full_name[128];
+                      struct stat st;
+
+                      snprintf (full_name, sizeof full_name, "%s/%s",
+                                dir, e->d_name);
+                      if (stat (full_name, &st) == 0)
+                        printf ("%d-byte file", st.st_size);
+                      else
+                        printf ("stat failed");
+                    }
+                  printf (", inumber %d", e->d_ino);
                 }
-              else
-                printf ("open failed");
-              close (entry_fd);
+              printf ("\n");
             }
-          printf ("\n");
         }
     }
   else 
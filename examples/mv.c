@@ -0,0 +1,23 @@
+/* mv.c
+
+   Renames or moves a file or directory, without copying it. */
+
+#include <stdio.h>
+#include <syscall.h>
+
+int
+main (int argc, char *argv[]) 
+{
+  if (argc != 3) 
+    {
+      printf ("usage: mv OLD NEW\n");
+      return EXIT_FAILURE;
+    }
+
+  if (!rename (argv[1], argv[2])) 
+    {
+      printf ("%s: rename to %s failed\n", argv[1], argv[2]);
+      return EXIT_FAILURE;
+    }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,87 @@
+/* randio.c
+
+   Random-access read benchmark.  Creates a 64 kB file and reads
+   512-byte blocks from it in random order, either with seek()
+   followed by read() or with a single pread().  Prints the
+   average cycles per access; the "Syscall:" line printed at
+   shutdown shows that the pread() run makes half as many system
+   calls.
+
+   Usage: randio seek|pread [ACCESSES] */
+
+#include <random.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <syscall.h>
+
+#define FILE_NAME "randio.dat"
+#define FILE_SIZE (64 * 1024)
+#define BLOCK_SIZE 512
+
+static char buf[BLOCK_SIZE];
+
+/* Returns the CPU's time-stamp counter. */
+static uint64_t
+rdtsc (void)
+{
+  uint64_t tsc;
+  asm volatile ("rdtsc" : "=A" (tsc));
+  return tsc;
+}
+
+int
+main (int argc, char *argv[])
+{
+  bool use_pread;
+  int accesses = 1000;
+  uint64_t start, cycles;
+  int fd, i;
+
+  if (argc < 2 || argc > 3
+      || (strcmp (argv[1], "seek") && strcmp (argv[1], "pread")))
+    {
+      printf ("usage: randio seek|pread [ACCESSES]\n");
+      return EXIT_FAILURE;
+    }
+  use_pread = !strcmp (argv[1], "pread");
+  if (argc == 3)
+    accesses = atoi (argv[2]);
+
+  /* Create the file. */
+  remove (FILE_NAME);
+  if (!create (FILE_NAME, FILE_SIZE) || (fd = open (FILE_NAME)) < 0)
+    {
+      printf ("randio: can't create %s\n", FILE_NAME);
+      return EXIT_FAILURE;
+    }
+
+  random_init (0);
+  start = rdtsc ();
+  for (i = 0; i < accesses; i++)
+    {
+      unsigned ofs = random_ulong () % (FILE_SIZE / BLOCK_SIZE) * BLOCK_SIZE;
+      int n;
+
+      if (use_pread)
+        n = pread (fd, buf, BLOCK_SIZE, ofs);
+      else
+        {
+          seek (fd, ofs);
+          n = read (fd, buf, BLOCK_SIZE);
+        }
+      if (n != BLOCK_SIZE)
+        {
+          printf ("randio: read at %u failed\n", ofs);
+          return EXIT_FAILURE;
+        }
+    }
+  cycles = rdtsc () - start;
+
+  close (fd);
+  remove (FILE_NAME);
+  printf ("randio: %d accesses with %s, %llu cycles per access\n",
+          accesses, use_pread ? "pread" : "seek+read", cycles / accesses);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,130 @@
+/* ringbench.c
+
+   Reads FILE from start to end twice in 512-byte blocks, first
+   with one read() system call per block, then by submitting
+   batches of reads through an io_ring (see lib/io-ring.h), and
+   prints the number of system calls and the cycles each pass
+   took. */
+
+#include <io-ring.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <syscall.h>
+
+#define BLOCK_SIZE 512
+#define BATCH 16
+
+static struct io_ring ring __attribute__ ((aligned (4096)));
+static char bufs[BATCH][BLOCK_SIZE];
+
+/* Returns the CPU's time-stamp counter. */
+static uint64_t
+rdtsc (void)
+{
+  uint64_t tsc;
+  asm volatile ("rdtsc" : "=A" (tsc));
+  return tsc;
+}
+
+/* Reads the file open as FD with read(), counting system calls
+   in *CALLS.  Returns the number of bytes read. */
+static int
+read_plain (int fd, int *calls)
+{
+  int total = 0;
+  int n;
+
+  do
+    {
+      n = read (fd, bufs[0], BLOCK_SIZE);
+      ++*calls;
+      if (n > 0)
+        total += n;
+    }
+  while (n == BLOCK_SIZE);
+  return total;
+}
+
+/* Reads the file open as FD through the ring, BATCH blocks per
+   io_ring_enter(), counting system calls in *CALLS.  Returns the
+   number of bytes read, or -1 on error. */
+static int
+read_ring (int fd, int *calls)
+{
+  int total = 0;
+  bool eof = false;
+
+  while (!eof)
+    {
+      int i;
+
+      for (i = 0; i < BATCH; i++)
+        {
+          struct io_sqe *sqe = &ring.sq[ring.sq_tail % IO_RING_ENTRIES];
+          sqe->op = IO_RING_READ;
+          sqe->fd = fd;
+          sqe->buf = bufs[i];
+          sqe->len = BLOCK_SIZE;
+          sqe->user_data = i;
+          ring.sq_tail++;
+        }
+      if (io_ring_enter (BATCH) != BATCH)
+        return -1;
+      ++*calls;
+
+      /* Reads run in order, so the first short one is the end of
+         the file. */
+      while (ring.cq_head != ring.cq_tail)
+        {
+          struct io_cqe *cqe = &ring.cq[ring.cq_head % IO_RING_ENTRIES];
+          if (cqe->result < 0)
+            return -1;
+          total += cqe->result;
+          if (cqe->result < BLOCK_SIZE)
+            eof = true;
+          ring.cq_head++;
+        }
+    }
+  return total;
+}
+
+int
+main (int argc, char *argv[])
+{
+  int calls, bytes, fd;
+  uint64_t start;
+
+  if (argc != 2)
+    {
+      printf ("usage: ringbench FILE\n");
+      return EXIT_FAILURE;
+    }
+  if (io_ring_setup (&ring) < 0)
+    {
+      printf ("ringbench: io_ring_setup failed\n");
+      return EXIT_FAILURE;
+    }
+
+  fd = open (argv[1]);
+  if (fd < 0)
+    {
+      printf ("ringbench: can't open %s\n", argv[1]);
+      return EXIT_FAILURE;
+    }
+
+  calls = 0;
+  start = rdtsc ();
+  bytes = read_plain (fd, &calls);
+  printf ("read:  %d bytes, %d system calls, %llu cycles\n",
+          bytes, calls, rdtsc () - start);
+
+  seek (fd, 0);
+  calls = 0;
+  start = rdtsc ();
+  bytes = read_ring (fd, &calls);
+  printf ("ring:  %d bytes, %d system calls, %llu cycles\n",
+          bytes, calls, rdtsc () - start);
+
+  close (fd);
+  return bytes < 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,83 @@
+/* tlbbench.c
+
+   Measures the cost of TLB misses within a single process.  The
+   program walks a 512 kB array twice per round: once a byte at a
+   time, which misses the TLB about once per 4096 accesses, and
+   once a page at a time, which misses on nearly every access.
+   The difference between the two per-access costs is roughly the
+   price of a TLB miss and the page walk behind it.
+
+   User memory always uses 4 kB pages, so this is the cost that
+   the kernel's 4 MB pages avoid for its own accesses.  Compare
+   runs with and without the kernel's -no-pse option to see how
+   much the kernel's TLB entries, loaded by every timer interrupt
+   taken during the walks, crowd out the user's.  Only memory
+   above the first 4 MB can be mapped with 4 MB pages, so give the
+   machine plenty of RAM, e.g. "pintos -m 64". */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <syscall.h>
+
+#define ARRAY_SIZE (512 * 1024)
+#define PAGE_SIZE 4096
+
+static char array[ARRAY_SIZE];
+
+/* Returns the CPU's time-stamp counter. */
+static uint64_t
+rdtsc (void)
+{
+  uint64_t tsc;
+  asm volatile ("rdtsc" : "=A" (tsc));
+  return tsc;
+}
+
+/* Adds 1 to every STRIDE'th byte of the array, starting at each
+   offset within the stride in turn, so that every byte is touched
+   once. */
+static void
+walk (size_t stride)
+{
+  size_t ofs, i;
+
+  for (ofs = 0; ofs < stride; ofs++)
+    for (i = ofs; i < ARRAY_SIZE; i += stride)
+      array[i]++;
+}
+
+int
+main (int argc, char *argv[])
+{
+  uint64_t start, seq_cycles, page_cycles, accesses;
+  int rounds = 5;
+  int i;
+
+  if (argc == 2)
+    rounds = atoi (argv[1]);
+  if (argc > 2 || rounds <= 0)
+    {
+      printf ("usage: tlbbench [ROUNDS]\n");
+      return 1;
+    }
+
+  /* Fault in the whole array before timing. */
+  walk (1);
+
+  start = rdtsc ();
+  for (i = 0; i < rounds; i++)
+    walk (1);
+  seq_cycles = rdtsc () - start;
+
+  start = rdtsc ();
+  for (i = 0; i < rounds; i++)
+    walk (PAGE_SIZE);
+  page_cycles = rdtsc () - start;
+
+  accesses = (uint64_t) rounds * ARRAY_SIZE;
+  printf ("tlbbench: %llu cycles per access in order, "
+          "%llu per access a page apart\n",
+          seq_cycles / accesses, page_cycles / accesses);
+  return 0;
+}
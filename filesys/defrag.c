@@ -0,0 +1,313 @@
+#include "filesys/defrag.h"
+#include <debug.h>
+#include <list.h>
+#include "filesys/directory.h"
+#include "filesys/filesys.h"
+#include "filesys/free-map.h"
+#include "filesys/inode.h"
+#include "filesys/journal.h"
+#include "filesys/reaper.h"
+#include "threads/malloc.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#ifdef USERPROG
+#include "userprog/syscall.h"
+#endif
+
+/* Online defragmenter.
+
+   Files written a sector at a time, or several at once, end up
+   scattered over the disk, so reading them sequentially seeks.
+   A pass of the defragmenter walks the directory tree from the
+   root and, for each regular file whose data is in more than one
+   run of sectors, finds the first run of free sectors big enough
+   to hold all of it and moves the data there.  A file that is
+   already contiguous is moved only if such a run lies before it,
+   which over repeated passes packs files toward the start of the
+   disk and leaves the free space in one piece at the end.
+
+   Data is moved DEFRAG_PIECE sectors at a time by
+   inode_relocate(), each piece in its own journal transaction,
+   which is committed before the old sectors can be reused.  The
+   file system lock is dropped and the CPU yielded between pieces,
+   so processes keep using the file system, and the files being
+   moved, while a pass runs.  Directories and the free map are
+   left alone.
+
+   A directory entry read with the lock dropped may name a file
+   that has since been removed and handed to the reaper, which
+   frees its blocks.  Such files are skipped, and a file removed
+   while it is being moved is left where it is; holding it open
+   keeps the reaper away from it until it is closed. */
+
+/* Data sectors moved per transaction. */
+#define DEFRAG_PIECE 128
+
+/* Directory entries read at a time. */
+#define DEFRAG_DIRENTS 16
+
+/* A directory still to be walked. */
+struct dir_item
+  {
+    struct list_elem elem;              /* Element in list of dirs. */
+    block_sector_t inumber;             /* Directory's inode. */
+  };
+
+static struct defrag_stats stats;       /* Progress, see lib/defrag.h. */
+static bool stopping;                   /* Stop the pass in progress? */
+static struct lock stats_lock;          /* Protects the above. */
+static struct condition pass_done;      /* Signaled when a pass ends. */
+static struct semaphore wake;           /* Upped to start a pass. */
+
+static thread_func defragger;
+static void run_pass (void);
+static void walk_dir (block_sector_t inumber, struct list *dirs);
+static void defrag_file (block_sector_t inumber);
+static bool should_stop (void);
+
+/* Takes the lock that serializes file system operations, if
+   there is one.  Every system call that reaches the file system
+   holds it, as does the reaper, so while the defragmenter holds
+   it no file, directory or free map changes under it. */
+static void
+fs_lock (void)
+{
+#ifdef USERPROG
+  lock_acquire (&read_write_lock);
+#endif
+}
+
+/* Releases the lock taken by fs_lock(). */
+static void
+fs_unlock (void)
+{
+#ifdef USERPROG
+  lock_release (&read_write_lock);
+#endif
+}
+
+/* Initializes the defragmenter and starts its thread, which
+   sleeps until defrag_start() is called. */
+void
+defrag_init (void)
+{
+  lock_init (&stats_lock);
+  cond_init (&pass_done);
+  sema_init (&wake, 0);
+  if (thread_create ("defrag", PRI_MIN, defragger, NULL) == TID_ERROR)
+    PANIC ("can't start defragmenter thread");
+}
+
+/* Stops the pass in progress, if any, and waits for it to end. */
+void
+defrag_done (void)
+{
+  lock_acquire (&stats_lock);
+  stopping = true;
+  while (stats.running)
+    cond_wait (&pass_done, &stats_lock);
+  lock_release (&stats_lock);
+}
+
+/* Starts a defragmentation pass, unless one is already running. */
+void
+defrag_start (void)
+{
+  lock_acquire (&stats_lock);
+  if (!stats.running && !stopping)
+    {
+      stats.running = true;
+      sema_up (&wake);
+    }
+  lock_release (&stats_lock);
+}
+
+/* Waits until no defragmentation pass is running. */
+void
+defrag_wait (void)
+{
+  lock_acquire (&stats_lock);
+  while (stats.running)
+    cond_wait (&pass_done, &stats_lock);
+  lock_release (&stats_lock);
+}
+
+/* Stores the defragmenter's progress and the state of free space
+   into *S. */
+void
+defrag_get_stats (struct defrag_stats *s)
+{
+  size_t runs, largest;
+
+  lock_acquire (&stats_lock);
+  *s = stats;
+  lock_release (&stats_lock);
+
+  fs_lock ();
+  free_map_runs (&runs, &largest);
+  fs_unlock ();
+  s->free_runs = runs;
+  s->free_largest = largest;
+}
+
+/* Defragmenter thread. */
+static void
+defragger (void *aux UNUSED)
+{
+  for (;;)
+    {
+      sema_down (&wake);
+      run_pass ();
+
+      lock_acquire (&stats_lock);
+      stats.running = false;
+      stats.passes++;
+      cond_broadcast (&pass_done, &stats_lock);
+      lock_release (&stats_lock);
+    }
+}
+
+/* Returns true if defrag_done() wants the pass to stop. */
+static bool
+should_stop (void)
+{
+  bool stop;
+
+  lock_acquire (&stats_lock);
+  stop = stopping;
+  lock_release (&stats_lock);
+  return stop;
+}
+
+/* Walks the directory tree, defragmenting every regular file. */
+static void
+run_pass (void)
+{
+  struct list dirs;
+  struct dir_item *d;
+
+  list_init (&dirs);
+  d = malloc (sizeof *d);
+  if (d == NULL)
+    return;
+  d->inumber = ROOT_DIR_INODE;
+  list_push_back (&dirs, &d->elem);
+
+  while (!list_empty (&dirs))
+    {
+      d = list_entry (list_pop_front (&dirs), struct dir_item, elem);
+      if (!should_stop ())
+        walk_dir (d->inumber, &dirs);
+      free (d);
+    }
+}
+
+/* Defragments the regular files in directory INUMBER and adds its
+   subdirectories to DIRS. */
+static void
+walk_dir (block_sector_t inumber, struct list *dirs)
+{
+  struct dirent *ents;
+  struct dir *dir;
+  size_t cnt, i;
+
+  ents = malloc (DEFRAG_DIRENTS * sizeof *ents);
+  if (ents == NULL)
+    return;
+  fs_lock ();
+  dir = reaper_pending (inumber) ? NULL : dir_open (inode_open (inumber));
+  fs_unlock ();
+  if (dir == NULL)
+    {
+      free (ents);
+      return;
+    }
+
+  do
+    {
+      fs_lock ();
+      cnt = dir_getdents (dir, ents, DEFRAG_DIRENTS);
+      fs_unlock ();
+      for (i = 0; i < cnt && !should_stop (); i++)
+        if (!ents[i].d_isdir)
+          defrag_file (ents[i].d_ino);
+        else
+          {
+            struct dir_item *d = malloc (sizeof *d);
+            if (d == NULL)
+              continue;
+            d->inumber = ents[i].d_ino;
+            list_push_back (dirs, &d->elem);
+          }
+    }
+  while (cnt > 0 && !should_stop ());
+
+  fs_lock ();
+  dir_close (dir);
+  fs_unlock ();
+  free (ents);
+}
+
+/* Moves the data of regular file INUMBER into one run of
+   sectors, if it is fragmented or there is room for it earlier on
+   disk. */
+static void
+defrag_file (block_sector_t inumber)
+{
+  struct inode *inode;
+  block_sector_t first, dest;
+  size_t cnt, extents, idx = 0, moved = 0;
+
+  fs_lock ();
+  inode = reaper_pending (inumber) ? NULL : inode_open (inumber);
+  if (inode == NULL)
+    {
+      fs_unlock ();
+      return;
+    }
+  extents = inode_extents (inode, &cnt, &first);
+  if (extents == 0 || !free_map_find (cnt, &dest)
+      || (extents == 1 && dest >= first))
+    cnt = 0;
+
+  /* Each piece goes right after the last, unless someone else
+     has taken those sectors in the meantime. */
+  while (moved < cnt && !inode->removed)
+    {
+      size_t piece = cnt - moved < DEFRAG_PIECE ? cnt - moved : DEFRAG_PIECE;
+      block_sector_t start;
+      size_t n;
+
+      if (!free_map_allocate_near (piece, dest + moved, &start))
+        break;
+      if (start != dest + moved)
+        {
+          free_map_release (start, piece);
+          break;
+        }
+      n = inode_relocate (inode, &idx, start, piece);
+      if (n < piece)
+        free_map_release (start + n, piece - n);
+
+      /* The old sectors must not be reused until the pointers to
+         the new ones are on disk. */
+      journal_flush ();
+      moved += n;
+
+      lock_acquire (&stats_lock);
+      stats.sectors_moved += n;
+      if (moved == n && n > 0)
+        stats.files_moved++;
+      lock_release (&stats_lock);
+
+      if (n < piece)
+        break;
+      fs_unlock ();
+      thread_yield ();
+      fs_lock ();
+      if (should_stop ())
+        break;
+    }
+  inode_close (inode);
+  fs_unlock ();
+}
@@ -0,0 +1,13 @@
+#ifndef FILESYS_DEFRAG_H
+#define FILESYS_DEFRAG_H
+
+#include <defrag.h>
+
+void defrag_init (void);
+void defrag_done (void);
+
+void defrag_start (void);
+void defrag_wait (void);
+void defrag_get_stats (struct defrag_stats *);
+
+#endif /* filesys/defrag.h */
@@ -4,6 +4,7 @@
 #include <list.h>
 #include "filesys/filesys.h"
 #include "filesys/inode.h"
+#include "filesys/journal.h"
 #include "threads/malloc.h"
 
 //#define DIRECTORY_DEBUG 1
@@ -53,7 +54,7 @@ dir_open_parent(struct dir * child_dir)
 struct dir *
 dir_open_root (void)
 {
-  struct inode* inode_root = inode_open (ROOT_DIR_SECTOR);
+  struct inode* inode_root = inode_open (ROOT_DIR_INODE);
   #ifdef DIRECTORY_DEBUG
   printf("dir open root: %p", inode_root);
   #endif
@@ -86,6 +87,15 @@ dir_get_inode (struct dir *dir)
   return dir->inode;
 }
 
+/* Writes DIR's inode to disk and commits all pending metadata,
+   which includes DIR's entries. */
+void
+dir_sync (struct dir *dir) 
+{
+  inode_flush (dir->inode);
+  journal_flush ();
+}
+
 /* Searches DIR for a file with the given NAME.
    If successful, returns true, sets *EP to the directory entry
    if EP is non-null, and sets *OFSP to the byte offset of the
@@ -247,6 +257,24 @@ dir_remove (struct dir *dir, const char *name)
   return success;
 }
 
+/* Erases the entry for NAME in DIR without removing the inode it
+   refers to, which is still linked from elsewhere.  Returns true
+   if successful, false if there is no file with the given NAME. */
+bool
+dir_unlink (struct dir *dir, const char *name) 
+{
+  struct dir_entry e;
+  off_t ofs;
+
+  ASSERT (dir != NULL);
+  ASSERT (name != NULL);
+
+  if (!lookup (dir, name, &e, &ofs))
+    return false;
+  e.in_use = false;
+  return inode_write_at (dir->inode, &e, sizeof e, ofs) == sizeof e;
+}
+
 /* Reads the next directory entry in DIR and stores the name in
    NAME.  Returns true if successful, false if the directory
    contains no more entries. */
@@ -265,3 +293,50 @@ dir_readdir (struct dir *dir, char name[NAME_MAX + 1])
     }
   return false;
 }
+
+/* Number of directory entries dir_getdents() reads at a time:
+   exactly 5 sectors' worth. */
+#define GETDENTS_CHUNK (5 * BLOCK_SECTOR_SIZE / sizeof (struct dir_entry))
+
+/* Reads up to MAX of the entries in use in DIR, starting at its
+   current position, into ENTS, and advances past them.  Entries
+   are read from the directory many sectors at a time rather than
+   one at a time as in dir_readdir().  Returns the number of
+   entries read, 0 at the end of the directory. */
+size_t
+dir_getdents (struct dir *dir, struct dirent *ents, size_t max)
+{
+  struct dir_entry *chunk;
+  size_t cnt = 0;
+
+  chunk = malloc (GETDENTS_CHUNK * sizeof *chunk);
+  if (chunk == NULL)
+    return 0;
+  while (cnt < max)
+    {
+      off_t left = inode_length (dir->inode) - dir->pos;
+      size_t n = left / sizeof *chunk;
+      size_t i;
+
+      if (n > GETDENTS_CHUNK)
+        n = GETDENTS_CHUNK;
+      if (n == 0
+          || inode_read_at (dir->inode, chunk, n * sizeof *chunk, dir->pos)
+             != (off_t) (n * sizeof *chunk))
+        break;
+
+      for (i = 0; i < n && cnt < max; i++)
+        {
+          dir->pos += sizeof *chunk;
+          if (chunk[i].in_use)
+            {
+              struct dirent *d = &ents[cnt++];
+              d->d_ino = chunk[i].inode_sector;
+              d->d_isdir = inode_is_dir (chunk[i].inode_sector);
+              strlcpy (d->d_name, chunk[i].name, sizeof d->d_name);
+            }
+        }
+    }
+  free (chunk);
+  return cnt;
+}
@@ -5,6 +5,7 @@
 #include <stddef.h>
 #include "devices/block.h"
 #include "filesys/off_t.h"
+#include <dirent.h>
 
 /* Maximum length of a file name component.
    This is the traditional UNIX maximum length.
@@ -39,12 +40,15 @@ struct dir *dir_open_root (void);
 struct dir *dir_reopen (struct dir *);
 void dir_close (struct dir *);
 struct inode *dir_get_inode (struct dir *);
+void dir_sync (struct dir *);
 
 /* Reading and writing. */
 bool dir_lookup (const struct dir *, const char *name, struct inode **);
 bool dir_add (struct dir *, const char *name, block_sector_t);
 bool dir_remove (struct dir *, const char *name);
+bool dir_unlink (struct dir *, const char *name);
 bool dir_readdir (struct dir *, char name[NAME_MAX + 1]);
+size_t dir_getdents (struct dir *, struct dirent *, size_t max);
 
 /* get the parent dir of child dir */
 /* input is the child dir */
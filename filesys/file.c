@@ -1,6 +1,7 @@
 #include "filesys/file.h"
 #include <debug.h>
 #include "filesys/inode.h"
+#include "filesys/journal.h"
 #include "threads/malloc.h"
 
 /* An open file. */
@@ -166,3 +167,31 @@ file_tell (struct file *file)
   ASSERT (file != NULL);
   return file->pos;
 }
+
+/* Writes FILE's unwritten data to disk, then commits all pending
+   metadata, including FILE's. */
+void
+file_sync (struct file *file) 
+{
+  ASSERT (file != NULL);
+  inode_flush (file->inode);
+  journal_flush ();
+}
+
+/* Sets FILE's length to LENGTH bytes, freeing the sectors past
+   the new end if it shrinks.  Returns true if successful. */
+bool
+file_truncate (struct file *file, off_t length) 
+{
+  ASSERT (file != NULL);
+  return inode_truncate (file->inode, length);
+}
+
+/* Reserves disk space for SIZE bytes of FILE starting at OFFSET,
+   without changing FILE's length.  Returns true if successful. */
+bool
+file_reserve (struct file *file, off_t offset, off_t size) 
+{
+  ASSERT (file != NULL);
+  return inode_reserve (file->inode, offset, size);
+}
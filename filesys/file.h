@@ -1,6 +1,7 @@
 #ifndef FILESYS_FILE_H
 #define FILESYS_FILE_H
 
+#include <stdbool.h>
 #include "filesys/off_t.h"
 
 struct inode;
@@ -25,5 +26,8 @@ void file_allow_write (struct file *);
 void file_seek (struct file *, off_t);
 off_t file_tell (struct file *);
 off_t file_length (struct file *);
+void file_sync (struct file *);
+bool file_truncate (struct file *, off_t length);
+bool file_reserve (struct file *, off_t offset, off_t size);
 
 #endif /* filesys/file.h */
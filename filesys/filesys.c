@@ -2,10 +2,13 @@
 #include <debug.h>
 #include <stdio.h>
 #include <string.h>
+#include "filesys/defrag.h"
 #include "filesys/file.h"
 #include "filesys/free-map.h"
 #include "filesys/inode.h"
 #include "filesys/directory.h"
+#include "filesys/journal.h"
+#include "filesys/reaper.h"
 #include "threads/thread.h"
 //#define FILESYS_DEBUG 1
 
@@ -32,11 +35,14 @@ filesys_init (bool format)
 
   inode_init ();
   free_map_init ();
+  journal_init (format);
 
   if (format) 
     do_format ();
 
   free_map_open ();
+  reaper_init (format);
+  defrag_init ();
 }
 
 /* Shuts down the file system module, writing any unwritten data
@@ -44,8 +50,49 @@ filesys_init (bool format)
 void
 filesys_done (void) 
 {
+  defrag_done ();
+  reaper_done ();
+  inode_flush_all ();
   free_map_close ();
+  journal_done ();
 }
+
+/* Writes all unwritten data and metadata to disk, first freeing
+   the space of removed files that the reaper has not reclaimed
+   yet. */
+void
+filesys_sync (void) 
+{
+  reaper_flush ();
+  inode_flush_all ();
+  journal_flush ();
+}
+
+/* Fills in ST with the metadata of the file or directory named
+   NAME, resolving NAME only once.  Returns true if successful,
+   false if NAME does not exist. */
+bool
+filesys_stat (const char *name, struct stat *st) 
+{
+  bool is_dir = false;
+  struct file *file = filesys_open (name, false, &is_dir);
+
+  if (file == NULL)
+    return false;
+  if (is_dir)
+    {
+      struct dir *dir = (struct dir *) file;
+      inode_stat (dir_get_inode (dir), st);
+      dir_close (dir);
+    }
+  else
+    {
+      inode_stat (file_get_inode (file), st);
+      file_close (file);
+    }
+  return true;
+}
+
 /* Creates a file named NAME with the given INITIAL_SIZE.
    Returns true if successful, false otherwise.
    Fails if a file named NAME already exists,
@@ -81,16 +128,19 @@ filesys_create (const char *name, off_t initial_size, bool type_dir)
   printf("filesys find succ %d parsed name %s\n", success, parsed_name);
   #endif
   if(success) {
+  journal_begin ();
   // Add the file/dir to the specifieddirectory
   success = (dir != NULL
-                  && free_map_allocate (1, &inode_sector)
+                  && inode_allocate (dir_get_inode (dir), &inode_sector)
                   && inode_create (inode_sector, initial_size, type_dir, parent_sector));
   #ifdef FILESYS_DEBUG
   printf("filesyscreate: success1 inode sec %d: %d\n",inode_sector, success);
  #endif
 
-  if(inode_sector == -1) // Exit with false if out ofmemory
+  if(inode_sector == -1) { // Exit with false if out ofmemory
+    journal_commit ();
     return false;
+  }
 
    success = dir_add (dir, parsed_name, inode_sector);
     #ifdef FILESYS_DEBUG
@@ -98,11 +148,12 @@ filesys_create (const char *name, off_t initial_size, bool type_dir)
   #endif
 
   if (!success && inode_sector != 0) 
-    free_map_release (inode_sector, 1);
+    inode_release (inode_sector);
 
   if(dir!=NULL)
    dir_close (dir); // Close the directory in which we added the new file to (thus updating it on disk)
   //inode_close(inode);
+  journal_commit ();
   }
   #ifdef FILESYS_DEBUG
 
@@ -496,21 +547,109 @@ filesys_remove (const char *name)
   
   if(strlen(parsed_name) > 14)
     return NULL;
+  journal_begin ();
   success = dir != NULL && dir_remove (dir, parsed_name);
   dir_close (dir); 
+  journal_commit ();
   }
 
 
   return success;
 }
 
+/* Returns true if the directory whose inode is in SECTOR is DIR
+   or one of DIR's ancestors. */
+static bool
+is_ancestor (block_sector_t sector, struct dir *dir) 
+{
+  block_sector_t cur = dir_get_inode (dir)->sector;
+
+  while (cur != sector && cur != ROOT_DIR_INODE)
+    {
+      struct inode *inode = inode_open (cur);
+      if (inode == NULL)
+        return false;
+      cur = inode->parent;
+      inode_close (inode);
+    }
+  return cur == sector;
+}
+
+/* Moves the file or directory named OLD_NAME to NEW_NAME, which
+   may be in a different directory, without copying its data.
+   The entry is linked into the new directory and unlinked from
+   the old one within a single journal transaction, so after a
+   crash the file has exactly one of the two names.
+   Returns true if successful, false on failure.
+   Fails if OLD_NAME does not exist, NEW_NAME already exists, or
+   a directory would be moved into itself or one of its own
+   subdirectories. */
+bool
+filesys_rename (const char *old_name, const char *new_name) 
+{
+  struct dir *old_dir = NULL, *new_dir = NULL;
+  struct inode *inode = NULL;
+  char old_parsed[100], new_parsed[100];
+  bool success = false;
+
+  if (strcmp (old_name, "") == 0 || strcmp (new_name, "") == 0)
+    return false;
+  if (!filesys_find_dir (old_name, NULL, &old_dir, NULL, old_parsed)
+      || old_dir == NULL)
+    return false;
+  if (!filesys_find_dir (new_name, NULL, &new_dir, NULL, new_parsed)
+      || new_dir == NULL)
+    {
+      dir_close (old_dir);
+      return false;
+    }
+  if (strlen (old_parsed) > NAME_MAX || strlen (new_parsed) > NAME_MAX
+      || dir_get_inode (new_dir)->removed
+      || !dir_lookup (old_dir, old_parsed, &inode))
+    goto done;
+
+  /* Renaming a file to itself changes nothing. */
+  if (dir_get_inode (old_dir) == dir_get_inode (new_dir)
+      && !strcmp (old_parsed, new_parsed))
+    {
+      success = true;
+      goto done;
+    }
+  if (inode->type_dir && is_ancestor (inode->sector, new_dir))
+    goto done;
+
+  journal_begin ();
+  success = dir_add (new_dir, new_parsed, inode->sector);
+  if (success)
+    {
+      dir_unlink (old_dir, old_parsed);
+      if (inode->type_dir)
+        {
+          inode_edit_parent (dir_get_inode (new_dir)->sector, inode);
+          inode_flush (inode);
+        }
+    }
+  inode_close (inode);
+  inode = NULL;
+  journal_commit ();
+
+ done:
+  inode_close (inode);
+  dir_close (old_dir);
+  dir_close (new_dir);
+  return success;
+}
+
 /* Formats the file system. */
 static void
 do_format (void)
 {
+  static char zeros[BLOCK_SECTOR_SIZE];
+
   printf ("Formatting file system...");
+  journal_write (INODE_TABLE_SECTOR, zeros);
   free_map_create ();
-  if (!dir_create(ROOT_DIR_SECTOR, 2))
+  if (!dir_create(ROOT_DIR_INODE, 2))
     PANIC ("root directory creation failed");
   free_map_close ();
   printf ("done.\n");
@@ -2,11 +2,18 @@
 #define FILESYS_FILESYS_H
 
 #include <stdbool.h>
+#include <stat.h>
 #include "filesys/off_t.h"
 
-/* Sectors of system file inodes. */
-#define FREE_MAP_SECTOR 0       /* Free map file inode sector. */
-#define ROOT_DIR_SECTOR 1       /* Root directory file inode sector. */
+/* Inode numbers of system files.  Both are in the first inode
+   table sector. */
+#define FREE_MAP_INODE 0        /* Free map file inode. */
+#define ROOT_DIR_INODE 1        /* Root directory file inode. */
+
+/* Sectors reserved at format time. */
+#define INODE_TABLE_SECTOR 0    /* First inode table sector. */
+#define ORPHAN_SECTOR 1         /* Removed inodes not yet reclaimed. */
+#define JOURNAL_SECTOR 2        /* Metadata journal header sector. */
 #define MAX_PATH_COUNT 20       /* Number of sub dir max limit in a path name */
 
 /* Block device that contains the file system. */
@@ -17,5 +24,8 @@ void filesys_done (void);
 bool filesys_create (const char *name, off_t initial_size, bool type_dir);
 struct file *filesys_open (const char *name,bool type_dir, bool* warning);
 bool filesys_remove (const char *name);
+bool filesys_rename (const char *old_name, const char *new_name);
+void filesys_sync (void);
+bool filesys_stat (const char *name, struct stat *);
 
 #endif /* filesys/filesys.h */
@@ -1,13 +1,29 @@
 #include "filesys/free-map.h"
 #include <bitmap.h>
 #include <debug.h>
+#include <stdlib.h>
 #include "filesys/file.h"
 #include "filesys/filesys.h"
 #include "filesys/inode.h"
+#include "filesys/journal.h"
 
 static struct file *free_map_file;   /* Free map file. */
 static struct bitmap *free_map;      /* Free map, one bit per sector. */
 
+/* Sectors freed in the journal group that is still open.  They
+   are free in FREE_MAP, which is written to disk in that group,
+   but until it is committed, the inodes that pointed to them
+   still do so on disk, and the file data that a new owner writes
+   straight to them would show through after a crash.  So they are
+   not handed out again until the group number moves past
+   PENDING_GROUP. */
+static struct bitmap *pending;       /* Freed, not yet committed. */
+static size_t pending_cnt;           /* Number of bits set in PENDING. */
+static unsigned pending_group;       /* Group that frees them. */
+
+static void mark_pending (block_sector_t, size_t cnt);
+static size_t scan_free (size_t start, size_t cnt);
+
 /* Initializes the free map. */
 void
 free_map_init (void) 
@@ -15,8 +31,12 @@ free_map_init (void)
   free_map = bitmap_create (block_size (fs_device));
   if (free_map == NULL)
     PANIC ("bitmap creation failed--file system device is too large");
-  bitmap_mark (free_map, FREE_MAP_SECTOR);
-  bitmap_mark (free_map, ROOT_DIR_SECTOR);
+  pending = bitmap_create (block_size (fs_device));
+  if (pending == NULL)
+    PANIC ("bitmap creation failed--file system device is too large");
+  bitmap_mark (free_map, INODE_TABLE_SECTOR);
+  bitmap_mark (free_map, ORPHAN_SECTOR);
+  bitmap_set_multiple (free_map, JOURNAL_SECTOR, JOURNAL_SECTORS, true);
 }
 
 /* Allocates CNT consecutive sectors from the free map and stores
@@ -27,7 +47,26 @@ free_map_init (void)
 bool
 free_map_allocate (size_t cnt, block_sector_t *sectorp)
 {
-  block_sector_t sector = bitmap_scan_and_flip (free_map, 0, cnt, false);
+  return free_map_allocate_near (cnt, 0, sectorp);
+}
+
+/* Like free_map_allocate(), but takes the first run of CNT free
+   sectors at or after HINT, if there is one, so that related
+   data can be placed close together. */
+bool
+free_map_allocate_near (size_t cnt, block_sector_t hint,
+                        block_sector_t *sectorp)
+{
+  block_sector_t sector = scan_free (hint, cnt);
+  if (sector == BITMAP_ERROR && hint != 0)
+    sector = scan_free (0, cnt);
+  if (sector == BITMAP_ERROR && pending_cnt > 0)
+    {
+      /* There may be room once the frees are committed. */
+      journal_request_flush ();
+    }
+  if (sector != BITMAP_ERROR)
+    bitmap_set_multiple (free_map, sector, cnt, true);
   if (sector != BITMAP_ERROR
       && free_map_file != NULL
       && !bitmap_write (free_map, free_map_file))
@@ -45,15 +84,141 @@ void
 free_map_release (block_sector_t sector, size_t cnt)
 {
   ASSERT (bitmap_all (free_map, sector, cnt));
+  journal_revoke (sector, cnt);
   bitmap_set_multiple (free_map, sector, cnt, false);
   bitmap_write (free_map, free_map_file);
+  mark_pending (sector, cnt);
+}
+
+/* Returns a negative, zero, or positive value as block sector
+   *A_ is less than, equal to, or greater than *B_. */
+static int
+compare_sectors (const void *a_, const void *b_) 
+{
+  const block_sector_t *a = a_;
+  const block_sector_t *b = b_;
+
+  return *a < *b ? -1 : *a > *b;
+}
+
+/* Makes the CNT sectors in SECTORS, which need not be in order or
+   consecutive, available for use.  SECTORS is sorted in place and
+   each run of consecutive sectors in it is released at once, and
+   the free map is written only once for the whole batch. */
+void
+free_map_release_batch (block_sector_t *sectors, size_t cnt)
+{
+  size_t start, end;
+
+  if (cnt == 0)
+    return;
+  qsort (sectors, cnt, sizeof *sectors, compare_sectors);
+  for (start = 0; start < cnt; start = end)
+    {
+      for (end = start + 1; end < cnt; end++)
+        if (sectors[end] != sectors[end - 1] + 1)
+          break;
+      ASSERT (bitmap_all (free_map, sectors[start], end - start));
+      journal_revoke (sectors[start], end - start);
+      bitmap_set_multiple (free_map, sectors[start], end - start, false);
+    }
+  bitmap_write (free_map, free_map_file);
+  for (start = 0; start < cnt; start = end)
+    {
+      for (end = start + 1; end < cnt; end++)
+        if (sectors[end] != sectors[end - 1] + 1)
+          break;
+      mark_pending (sectors[start], end - start);
+    }
+}
+
+/* Forgets the pending frees if the group that made them has been
+   committed. */
+static void
+retire_pending (void)
+{
+  if (pending_cnt > 0 && journal_group () != pending_group)
+    {
+      bitmap_set_all (pending, false);
+      pending_cnt = 0;
+    }
+}
+
+/* Keeps the CNT sectors starting at SECTOR, just freed, from
+   being allocated until the free is committed.  Must be called
+   after the free map is written, so that the group it reads is
+   the one that frees them or a later one. */
+static void
+mark_pending (block_sector_t sector, size_t cnt)
+{
+  retire_pending ();
+  bitmap_set_multiple (pending, sector, cnt, true);
+  pending_cnt += cnt;
+  pending_group = journal_group ();
+}
+
+/* Returns the first sector of the first run of CNT sectors at or
+   after START that are free and not pending, or BITMAP_ERROR if
+   there is none. */
+static size_t
+scan_free (size_t start, size_t cnt)
+{
+  retire_pending ();
+  for (;;)
+    {
+      size_t sector = bitmap_scan (free_map, start, cnt, false);
+      if (sector == BITMAP_ERROR || pending_cnt == 0
+          || bitmap_none (pending, sector, cnt))
+        return sector;
+      start = sector + 1;
+    }
+}
+
+/* Stores the first sector of the first run of CNT free sectors
+   into *SECTORP, without allocating them.  Returns true if
+   successful, false if there is no such run. */
+bool
+free_map_find (size_t cnt, block_sector_t *sectorp) 
+{
+  size_t sector = scan_free (0, cnt);
+
+  if (sector == BITMAP_ERROR)
+    return false;
+  *sectorp = sector;
+  return true;
+}
+
+/* Stores the number of runs of consecutive free sectors into
+   *RUNS and the length of the longest into *LARGEST. */
+void
+free_map_runs (size_t *runs, size_t *largest) 
+{
+  size_t size = bitmap_size (free_map);
+  size_t start = 0;
+
+  *runs = *largest = 0;
+  while (start < size)
+    {
+      size_t end;
+
+      start = bitmap_scan (free_map, start, 1, false);
+      if (start == BITMAP_ERROR)
+        break;
+      end = bitmap_scan (free_map, start, 1, true);
+      if (end == BITMAP_ERROR)
+        end = size;
+      ++*runs;
+      if (end - start > *largest)
+        *largest = end - start;
+      start = end;
+    }
 }
 
 /* Opens the free map file and reads it from disk. */
 void
 free_map_open (void) 
 {
-  free_map_file = file_open (inode_open (FREE_MAP_SECTOR));
+  free_map_file = file_open (inode_open (FREE_MAP_INODE));
   if (free_map_file == NULL)
     PANIC ("can't open free map");
   if (!bitmap_read (free_map, free_map_file))
@@ -73,10 +238,10 @@ void
 free_map_create (void) 
 {
   /* Create inode. */
-  if (!inode_create (FREE_MAP_SECTOR, bitmap_file_size (free_map), false, -1))
+  if (!inode_create (FREE_MAP_INODE, bitmap_file_size (free_map), false, -1))
     PANIC ("free map creation failed");
   /* Write bitmap to file. */
-  free_map_file = file_open (inode_open (FREE_MAP_SECTOR));
+  free_map_file = file_open (inode_open (FREE_MAP_INODE));
   if (free_map_file == NULL)
     PANIC ("can't open free map");
   if (!bitmap_write (free_map, free_map_file))
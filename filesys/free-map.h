@@ -12,6 +12,10 @@ void free_map_open (void);
 void free_map_close (void);
 
 bool free_map_allocate (size_t, block_sector_t *);
+bool free_map_allocate_near (size_t, block_sector_t hint, block_sector_t *);
 void free_map_release (block_sector_t, size_t);
+void free_map_release_batch (block_sector_t *, size_t cnt);
+bool free_map_find (size_t cnt, block_sector_t *);
+void free_map_runs (size_t *runs, size_t *largest);
 
 #endif /* filesys/free-map.h */
@@ -117,12 +117,16 @@ fsutil_extract (char **argv UNUSED)
 
           printf ("Putting '%s' into the file system...\n", file_name);
 
-          /* Create destination file. */
-          if (!filesys_create (file_name, size,false))
+          /* Create destination file, with all of its space
+             reserved up front so that it is laid out contiguously
+             and the writes below need not allocate. */
+          if (!filesys_create (file_name, 0, false))
             PANIC ("%s: create failed", file_name);
           dst = filesys_open (file_name, false, NULL);
           if (dst == NULL)
             PANIC ("%s: open failed", file_name);
+          if (!file_reserve (dst, 0, size))
+            PANIC ("%s: out of disk space", file_name);
 
           /* Do copy. */
           while (size > 0)
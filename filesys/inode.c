@@ -5,13 +5,38 @@
 #include <string.h>
 #include "filesys/filesys.h"
 #include "filesys/free-map.h"
+#include "filesys/journal.h"
+#include "filesys/reaper.h"
 #include "threads/malloc.h"
 //#define INODE_DEBUG 2
 
 /* Identifies an inode. */
 #define INODE_MAGIC 0x494e4f44
 
-bool inode_expand(struct inode_disk *inode, off_t length, bool create);
+/* Largest file whose data is stored in its inode, in the space
+   that otherwise holds the direct block pointers. */
+#define INLINE_MAX ((off_t) sizeof ((struct inode_disk *) 0)->direct)
+
+/* Most dirty sectors an inode may buffer in memory before they
+   are flushed to disk. */
+#define DIRTY_MAX 64
+
+/* Most sectors inode_reserve() places in one journal group.  Each
+   needs at most one new indirect block per INDIRECT_BLOCK_SIZE
+   sectors, so a run this long fits in the room journal_begin()
+   leaves. */
+#define RESERVE_RUN (16 * INDIRECT_BLOCK_SIZE)
+
+/* A sector of a file's data that has been written but not yet
+   flushed to disk.  A sector written into a hole has no disk
+   sector until it is flushed. */
+struct dirty_sector
+  {
+    struct list_elem elem;              /* Element in inode's list. */
+    size_t idx;                         /* Sector index within file. */
+    block_sector_t sector;              /* Disk sector, 0 if a hole. */
+    uint8_t data[BLOCK_SECTOR_SIZE];    /* Contents. */
+  };
 
 /* Returns the number of sectors to allocate for an inode SIZE
    bytes long. */
@@ -22,88 +47,532 @@ bytes_to_sectors (off_t size)
 }
 
 
+/* Returns true if INODE's data is file system metadata, which
+   is written through the journal: the free map and directories.
+   Inode table sectors and indirect blocks are always metadata. */
+static bool
+is_metadata (const struct inode *inode)
+{
+  return inode->type_dir || inode->sector == FREE_MAP_INODE;
+}
+
+/* Reads data sector SECTOR of INODE into BUFFER. */
+static void
+read_data (const struct inode *inode, block_sector_t sector, void *buffer)
+{
+  if (is_metadata (inode))
+    journal_read (sector, buffer);
+  else
+    block_read (fs_device, sector, buffer);
+}
+
+/* Writes BUFFER to data sector SECTOR of INODE. */
+static void
+write_data (const struct inode *inode, block_sector_t sector,
+            const void *buffer)
+{
+  if (is_metadata (inode))
+    journal_write (sector, buffer);
+  else
+    block_write (fs_device, sector, buffer);
+}
+
+/* Returns the sector that holds sector IDX of DISK_INODE's data,
+   or 0 if that part of the file is a hole that has never been
+   written.  (Sector 0 holds the free map's inode, so it is never
+   a data sector.)
+
+   If ALLOCATE is true, a hole is first filled in with a newly
+   allocated sector, along with any indirect blocks needed to
+   point to it.  The caller must then write DISK_INODE back to
+   disk.  If FRESH is null, the new sector is zeroed; otherwise
+   it is left as it is on disk and *FRESH is set to true, so that
+   the caller, which is about to write it, only has to zero the
+   parts it does not overwrite.  *FRESH is set to false if the
+   sector already existed.  Returns 0 if the disk is full or IDX
+   is past the largest file the inode can describe.
+
+   If NEW_SECTOR is nonzero, a hole is filled in with NEW_SECTOR,
+   which the caller has already allocated, instead of a sector
+   from the free map.  NEW_SECTOR is never zeroed, whether or not
+   FRESH is null: the caller is about to write its contents. */
 static block_sector_t
-byte_to_db_indirect_sector(const struct inode *inode, off_t length, off_t pos)
+lookup_sector (struct inode_disk *disk_inode, size_t idx, bool allocate,
+               bool *fresh, block_sector_t new_sector)
 {
-  //printf("Hello\n");
-   if(pos < (DIRECT_BLOCK_SIZE*BLOCK_SECTOR_SIZE + INDIRECT_BLOCK_SIZE*BLOCK_SECTOR_SIZE + INDIRECT_BLOCK_SIZE*BLOCK_SECTOR_SIZE*INDIRECT_BLOCK_SIZE))
-   {
-    struct indirect_block block;
-    for(int i = 0; i < INDIRECT_BLOCK_SIZE; i++)
+  static char zeros[BLOCK_SECTOR_SIZE];
+  struct indirect_block block;
+  block_sector_t *slot;
+  block_sector_t parent = 0;
+  bool parent_fresh = false;
+  size_t offsets[2];
+  int levels, level;
+
+  /* Find the inode's pointer to follow first and the offsets
+     into each level of indirect block below it. */
+  if (idx < DIRECT_BLOCK_SIZE)
+    {
+      slot = &disk_inode->direct[idx];
+      levels = 0;
+    }
+  else if ((idx -= DIRECT_BLOCK_SIZE) < INDIRECT_BLOCK_SIZE)
     {
-      block.ind_ptrs[i] = 0;
+      slot = &disk_inode->indirect_ptr;
+      offsets[0] = idx;
+      levels = 1;
     }
-  //printf("Hello2\n");
+  else if ((idx -= INDIRECT_BLOCK_SIZE)
+           < INDIRECT_BLOCK_SIZE * DBINDIRECT_BLOCK_SIZE)
+    {
+      slot = &disk_inode->db_indirect_ptr;
+      offsets[0] = idx / INDIRECT_BLOCK_SIZE;
+      offsets[1] = idx % INDIRECT_BLOCK_SIZE;
+      levels = 2;
+    }
+  else
+    return 0;
+
+  /* SLOT points into the inode at first, then into BLOCK, which
+     holds a copy of indirect block PARENT.  A new indirect block
+     is not zeroed on disk, since it is written as soon as the
+     pointer below it is filled in. */
+  for (level = 0; ; level++)
+    {
+      bool allocated = false;
+
+      if (*slot == 0)
+        {
+          if (level == levels && new_sector != 0)
+            *slot = new_sector;
+          else if (!allocate || !free_map_allocate (1, slot))
+            {
+              if (parent_fresh)
+                journal_write (parent, &block);
+              return 0;
+            }
+          disk_inode->sector_cnt++;
+          if (level == levels && fresh == NULL && new_sector == 0)
+            journal_write (*slot, zeros);
+          if (parent != 0)
+            journal_write (parent, &block);
+          allocated = true;
+        }
+      if (level == levels)
+        {
+          if (fresh != NULL)
+            *fresh = allocated;
+          return *slot;
+        }
 
-    ASSERT(inode->data.db_indirect_ptr > 0);
-    block_read(fs_device, inode->data.db_indirect_ptr, &block);
-    int pos_db_indirect = pos - DIRECT_BLOCK_SIZE*BLOCK_SECTOR_SIZE - INDIRECT_BLOCK_SIZE*BLOCK_SECTOR_SIZE;
+      parent = *slot;
+      parent_fresh = allocated;
+      if (allocated)
+        memset (&block, 0, sizeof block);
+      else
+        journal_read (parent, &block);
+      slot = &block.ind_ptrs[offsets[level]];
+    }
+}
 
-    int db_ind_index = pos_db_indirect / (INDIRECT_BLOCK_SIZE*BLOCK_SECTOR_SIZE);
-  //printf("Hell3.2 %d %d", db_ind_index, pos_db_indirect);
-    int ind_index = ( pos_db_indirect % (INDIRECT_BLOCK_SIZE*BLOCK_SECTOR_SIZE) ) / BLOCK_SECTOR_SIZE;
-  //printf("Hello3 %d %d %d\n", ind_index, db_ind_index, block.ind_ptrs[db_ind_index]);
-    struct indirect_block block2;
+/* Points sector IDX of DISK_INODE's data, which must not be a
+   hole, at disk sector SECTOR instead, writing back the indirect
+   block that holds the pointer, if any.  The caller must then
+   write DISK_INODE back to disk. */
+static void
+remap_sector (struct inode_disk *disk_inode, size_t idx, block_sector_t sector)
+{
+  struct indirect_block block;
+  block_sector_t parent;
 
-    for(int i = 0; i < INDIRECT_BLOCK_SIZE; i++)
+  if (idx < DIRECT_BLOCK_SIZE)
     {
-      block2.ind_ptrs[i] = 0;
+      disk_inode->direct[idx] = sector;
+      return;
     }
-    block_read(fs_device, block.ind_ptrs[db_ind_index], &block2);
-    
-  //printf("Hello4 %d\n", block2.ind_ptrs[ind_index]);
+  idx -= DIRECT_BLOCK_SIZE;
+  if (idx < INDIRECT_BLOCK_SIZE)
+    parent = disk_inode->indirect_ptr;
+  else
+    {
+      idx -= INDIRECT_BLOCK_SIZE;
+      journal_read (disk_inode->db_indirect_ptr, &block);
+      parent = block.ind_ptrs[idx / INDIRECT_BLOCK_SIZE];
+      idx %= INDIRECT_BLOCK_SIZE;
+    }
+  journal_read (parent, &block);
+  block.ind_ptrs[idx] = sector;
+  journal_write (parent, &block);
+}
 
-    return block2.ind_ptrs[ind_index];
-   }
+/* Returns the block device sector that contains byte offset POS
+   within INODE, or 0 if POS lies in a hole. */
+static block_sector_t
+byte_to_sector (struct inode *inode, off_t pos) 
+{
+  ASSERT (inode != NULL);
+  return lookup_sector (&inode->data, pos / BLOCK_SECTOR_SIZE, false, NULL, 0);
+}
 
-   int return_sector = -1;
-   ASSERT(return_sector == 0);
-   return (block_sector_t) return_sector;
+/* Frees all of INODE's dirty sectors without writing them. */
+static void
+discard_dirty_sectors (struct inode *inode)
+{
+  while (!list_empty (&inode->dirty))
+    {
+      struct list_elem *e = list_pop_front (&inode->dirty);
+      free (list_entry (e, struct dirty_sector, elem));
+    }
+  inode->dirty_cnt = 0;
 }
 
-static block_sector_t
-byte_to_indirect_sector(const struct inode *inode, off_t length, off_t pos)
+/* Returns true if dirty sector A is stored before dirty sector B
+   on disk. */
+static bool
+dirty_sector_less (const struct list_elem *a_, const struct list_elem *b_,
+                   void *aux UNUSED)
+{
+  const struct dirty_sector *a = list_entry (a_, struct dirty_sector, elem);
+  const struct dirty_sector *b = list_entry (b_, struct dirty_sector, elem);
+
+  return a->sector < b->sector;
+}
+
+/* Writes INODE's dirty sectors to disk, in sector order.
+
+   Holes are given disk space first.  Each run of consecutive
+   holes is placed in one run of consecutive free sectors, if
+   there is one, so that files written a little at a time still
+   end up contiguous.  If the disk is full, the sectors that do
+   not fit are lost, as if the writes that made them had failed.
+   The caller must write INODE's own sector afterward. */
+static void
+flush_dirty_sectors (struct inode *inode)
+{
+  struct list_elem *e, *next;
+
+  for (e = list_begin (&inode->dirty); e != list_end (&inode->dirty);
+       e = next)
+    {
+      struct dirty_sector *first = list_entry (e, struct dirty_sector, elem);
+      block_sector_t start;
+      size_t cnt = 0, i;
+
+      next = list_next (e);
+      if (first->sector != 0)
+        continue;
+
+      /* Find the run of holes that starts at FIRST, then the
+         longest stretch of free sectors, up to its length, to put
+         it in. */
+      for (next = e; next != list_end (&inode->dirty); next = list_next (next))
+        {
+          struct dirty_sector *ds = list_entry (next, struct dirty_sector, elem);
+          if (ds->sector != 0 || ds->idx != first->idx + cnt)
+            break;
+          cnt++;
+        }
+      while (cnt > 0 && !free_map_allocate (cnt, &start))
+        cnt--;
+      if (cnt == 0)
+        break;
+
+      for (i = 0, next = e; i < cnt; i++, next = list_next (next))
+        {
+          struct dirty_sector *ds = list_entry (next, struct dirty_sector, elem);
+          if (lookup_sector (&inode->data, ds->idx, true, NULL, start + i) != 0)
+            ds->sector = start + i;
+          else
+            free_map_release (start + i, 1);
+        }
+    }
+
+  list_sort (&inode->dirty, dirty_sector_less, NULL);
+  for (e = list_begin (&inode->dirty); e != list_end (&inode->dirty);
+       e = list_next (e))
+    {
+      struct dirty_sector *ds = list_entry (e, struct dirty_sector, elem);
+      if (ds->sector != 0)
+        write_data (inode, ds->sector, ds->data);
+    }
+  discard_dirty_sectors (inode);
+}
+
+/* Frees INODE's dirty copies of sector KEEP of its data and all
+   later sectors, without writing them. */
+static void
+discard_dirty_tail (struct inode *inode, size_t keep)
+{
+  struct list_elem *e = list_rbegin (&inode->dirty);
+
+  while (e != list_rend (&inode->dirty))
+    {
+      struct dirty_sector *ds = list_entry (e, struct dirty_sector, elem);
+      if (ds->idx < keep)
+        break;
+      e = list_prev (e);
+      list_remove (&ds->elem);
+      free (ds);
+      inode->dirty_cnt--;
+    }
+}
+
+/* Returns INODE's dirty copy of sector IDX of its data, or a null
+   pointer if there is none. */
+static struct dirty_sector *
+find_dirty_sector (struct inode *inode, size_t idx)
 {
-   if(pos < (DIRECT_BLOCK_SIZE*BLOCK_SECTOR_SIZE + INDIRECT_BLOCK_SIZE*BLOCK_SECTOR_SIZE))
-   {
-    struct indirect_block block;
-    for(int i = 0; i < INDIRECT_BLOCK_SIZE; i++)
+  struct list_elem *e;
+
+  for (e = list_begin (&inode->dirty); e != list_end (&inode->dirty);
+       e = list_next (e))
     {
-      block.ind_ptrs[i] = 0;
+      struct dirty_sector *ds = list_entry (e, struct dirty_sector, elem);
+      if (ds->idx == idx)
+        return ds;
+      if (ds->idx > idx)
+        break;
     }
+  return NULL;
+}
 
-    ASSERT(inode->data.indirect_ptr > 0);
-    block_read(fs_device, inode->data.indirect_ptr, &block);
-    int pos_indirect = pos - DIRECT_BLOCK_SIZE*BLOCK_SECTOR_SIZE;
-    return block.ind_ptrs[pos_indirect / BLOCK_SECTOR_SIZE];
-   }
+/* Adds a dirty copy of sector IDX of INODE's data, which has no
+   dirty copy yet, and returns it.  SECTOR is the disk sector that
+   holds it, or 0 if it is a hole.  If LOAD is true, the copy
+   starts out with SECTOR's contents, otherwise with zeros.
+   Returns a null pointer if memory is exhausted. */
+static struct dirty_sector *
+add_dirty_sector (struct inode *inode, size_t idx, block_sector_t sector,
+                  bool load)
+{
+  struct dirty_sector *ds;
+  struct list_elem *e;
 
+  /* Make room first, so that memory use stays bounded. */
+  if (inode->dirty_cnt >= DIRTY_MAX)
+    flush_dirty_sectors (inode);
 
-   return byte_to_db_indirect_sector(inode, length, pos);
+  ds = malloc (sizeof *ds);
+  if (ds == NULL)
+    return NULL;
+  ds->idx = idx;
+  ds->sector = sector;
+  if (load && sector != 0)
+    read_data (inode, sector, ds->data);
+  else
+    memset (ds->data, 0, sizeof ds->data);
+
+  for (e = list_begin (&inode->dirty); e != list_end (&inode->dirty);
+       e = list_next (e))
+    if (list_entry (e, struct dirty_sector, elem)->idx > idx)
+      break;
+  list_insert (e, &ds->elem);
+  inode->dirty_cnt++;
+  return ds;
 }
 
+/* Reads inode INUMBER from its inode table sector into
+   DISK_INODE. */
+static void
+read_inode (block_sector_t inumber, struct inode_disk *disk_inode)
+{
+  struct inode_disk table[INODES_PER_SECTOR];
 
+  journal_read (inumber / INODES_PER_SECTOR, table);
+  *disk_inode = table[inumber % INODES_PER_SECTOR];
+}
 
-/* Returns the block device sector that contains byte offset POS
-   within INODE.
-   Returns -1 if the byte offest POS
-   refers to a indirect or dbl_indirect sector*/
-static block_sector_t
-byte_to_sector (const struct inode *inode, off_t length, off_t pos) 
+/* Writes DISK_INODE to inode INUMBER's slot in its inode table
+   sector. */
+static void
+write_inode (block_sector_t inumber, const struct inode_disk *disk_inode)
 {
-  ASSERT (inode != NULL);
-  //printf("pos %d\n", pos);
-  if (pos <  DIRECT_BLOCK_SIZE*BLOCK_SECTOR_SIZE) {
+  struct inode_disk table[INODES_PER_SECTOR];
 
-    //makeprintf("inode->data.direct[] %d\n", inode->data.direct[pos / BLOCK_SECTOR_SIZE]);
-    return inode->data.direct[pos / BLOCK_SECTOR_SIZE];
-  }
-  //printf("length %d pos %d\n", length, pos);
-  
-  return byte_to_indirect_sector(inode, length, pos);
+  journal_read (inumber / INODES_PER_SECTOR, table);
+  table[inumber % INODES_PER_SECTOR] = *disk_inode;
+  journal_write (inumber / INODES_PER_SECTOR, table);
+}
+
+/* Looks for a free slot in inode table sector SECTOR, which is
+   empty if FRESH is true.  If there is one, reserves it, stores
+   its inode number in *INUMBERP and returns true; otherwise
+   returns false. */
+static bool
+allocate_slot (block_sector_t sector, bool fresh, block_sector_t *inumberp)
+{
+  struct inode_disk table[INODES_PER_SECTOR];
+  size_t i;
+
+  if (fresh)
+    memset (table, 0, sizeof table);
+  else
+    journal_read (sector, table);
+  for (i = 0; i < INODES_PER_SECTOR; i++)
+    if (table[i].magic != INODE_MAGIC)
+      {
+        memset (&table[i], 0, sizeof table[i]);
+        table[i].magic = INODE_MAGIC;
+        journal_write (sector, table);
+        *inumberp = sector * INODES_PER_SECTOR + i;
+        return true;
+      }
+  return false;
+}
+
+/* Allocates an inode number for a new file in directory PARENT
+   and stores it in *INUMBERP.  The inode is placed in the same
+   inode table sector as PARENT or its most recently created
+   sibling if either has room, or else in a new table sector
+   close to PARENT's, so that the inodes of a directory's files
+   are read together.  The caller must initialize the inode with
+   inode_create().  Returns true if successful, false if the disk
+   is full. */
+bool
+inode_allocate (struct inode *parent, block_sector_t *inumberp)
+{
+  block_sector_t parent_table = parent->sector / INODES_PER_SECTOR;
+  block_sector_t sector;
+
+  if (allocate_slot (parent_table, false, inumberp))
+    return true;
+  if (parent->child_table != 0
+      && allocate_slot (parent->child_table, false, inumberp))
+    return true;
+
+  if (!free_map_allocate_near (1, parent_table, &sector))
+    return false;
+  parent->child_table = sector;
+  return allocate_slot (sector, true, inumberp);
+}
+
+/* Frees inode number INUMBER, and its inode table sector if no
+   other inodes are left in it. */
+void
+inode_release (block_sector_t inumber) 
+{
+  struct inode_disk table[INODES_PER_SECTOR];
+  block_sector_t sector = inumber / INODES_PER_SECTOR;
+  size_t i;
+
+  journal_read (sector, table);
+  memset (&table[inumber % INODES_PER_SECTOR], 0, sizeof *table);
+  for (i = 0; i < INODES_PER_SECTOR; i++)
+    if (table[i].magic == INODE_MAGIC)
+      {
+        journal_write (sector, table);
+        return;
+      }
+  if (sector != INODE_TABLE_SECTOR)
+    free_map_release (sector, 1);
+  else
+    journal_write (sector, table);
+}
+
+/* Sectors gathered for release by release_tail(). */
+struct reclaim
+  {
+    block_sector_t *sectors;            /* Gathered sectors. */
+    size_t cnt;                         /* Number of SECTORS in use. */
+    size_t cap;                         /* Capacity of SECTORS. */
+    size_t total;                       /* Number ever added. */
+  };
+
+/* Adds SECTOR to R, unless it is a hole, first releasing the
+   sectors already gathered if R is full. */
+static void
+reclaim_add (struct reclaim *r, block_sector_t sector) 
+{
+  if (sector == 0)
+    return;
+  if (r->cnt == r->cap)
+    {
+      free_map_release_batch (r->sectors, r->cnt);
+      r->cnt = 0;
+    }
+  r->sectors[r->cnt++] = sector;
+  r->total++;
+}
+
+/* Adds to R the sectors reachable from indirect block *SLOT that
+   hold file sector KEEP or later, and clears the pointers to
+   them.  The block maps the file's sectors starting at index
+   BASE.  If LEVELS is 2, it is a doubly indirect block, and the
+   indirect blocks it points to are walked in turn.  If the block
+   maps nothing before KEEP, it is added to R as well and *SLOT is
+   cleared; otherwise its new contents are written back. */
+static void
+reclaim_indirect (struct reclaim *r, block_sector_t *slot, int levels,
+                  size_t base, size_t keep) 
+{
+  size_t span = levels > 1 ? INDIRECT_BLOCK_SIZE : 1;
+  struct indirect_block *block;
+  size_t i;
+
+  if (*slot == 0 || base + span * INDIRECT_BLOCK_SIZE <= keep)
+    return;
+  block = malloc (sizeof *block);
+  if (block == NULL)
+    PANIC ("can't allocate indirect block buffer");
+  journal_read (*slot, block);
+  for (i = 0; i < INDIRECT_BLOCK_SIZE; i++)
+    if (levels > 1)
+      reclaim_indirect (r, &block->ind_ptrs[i], levels - 1,
+                        base + i * span, keep);
+    else if (base + i >= keep)
+      {
+        reclaim_add (r, block->ind_ptrs[i]);
+        block->ind_ptrs[i] = 0;
+      }
+  if (base >= keep)
+    {
+      reclaim_add (r, *slot);
+      *slot = 0;
+    }
+  else
+    journal_write (*slot, block);
+  free (block);
 }
 
+/* Frees every data sector of DISK_INODE from file sector KEEP
+   on, along with the indirect blocks that no longer map anything,
+   but not the inode itself.  The sectors are gathered first and
+   released in batches, so that the free map is written once per
+   batch rather than once per sector; a batch normally holds the
+   whole file. */
+static void
+release_tail (struct inode_disk *disk_inode, size_t keep) 
+{
+  block_sector_t small[32];
+  struct reclaim r;
+  size_t i;
+
+  if (disk_inode->inline_data)
+    return;
+
+  r.cnt = r.total = 0;
+  r.cap = disk_inode->sector_cnt;
+  r.sectors = r.cap > 0 ? malloc (r.cap * sizeof *r.sectors) : NULL;
+  if (r.sectors == NULL)
+    {
+      r.sectors = small;
+      r.cap = sizeof small / sizeof *small;
+    }
 
+  for (i = keep; i < DIRECT_BLOCK_SIZE; i++)
+    {
+      reclaim_add (&r, disk_inode->direct[i]);
+      disk_inode->direct[i] = 0;
+    }
+  reclaim_indirect (&r, &disk_inode->indirect_ptr, 1,
+                    DIRECT_BLOCK_SIZE, keep);
+  reclaim_indirect (&r, &disk_inode->db_indirect_ptr, 2,
+                    DIRECT_BLOCK_SIZE + INDIRECT_BLOCK_SIZE, keep);
+  free_map_release_batch (r.sectors, r.cnt);
+
+  if (r.sectors != small)
+    free (r.sectors);
+  disk_inode->sector_cnt -= r.total;
+}
 
 /* List of open inodes, so that opening a single inode twice
    returns the same `struct inode'. */
@@ -117,91 +586,52 @@ inode_init (void)
 }
 
 /* Initializes an inode with LENGTH bytes of data and
-   writes the new inode to sector SECTOR on the file system
-   device.
+   writes the new inode to inode number SECTOR on the file system
+   device.  No data sectors are allocated: a small file's data is
+   kept inside the inode until it grows too big, and a larger
+   file starts out as one hole that reads as zeros, with sectors
+   allocated as they are first written.
    Returns true if successful.
    Returns false if memory or disk allocation fails. */
 bool
 inode_create (block_sector_t sector, off_t length, bool type_dir, block_sector_t parent_sector)
 {
-  //The sectors all need to be allocated here. Always allocate enough for the file size of length n
   struct inode_disk *disk_inode = NULL;
   bool success = false;
-  static char zeroes[BLOCK_SECTOR_SIZE]; //This is a block of purely zeroes so we can "clean" the data inside the sectors we allocate
 
   ASSERT (length >= 0);
-  //printf("%d\n", sizeof *disk_inode);
 
-  /* If this assertion fails, the inode structure is not exactly
-     one sector in size, and you should fix that. */
-  ASSERT (sizeof *disk_inode == BLOCK_SECTOR_SIZE);
+  /* If this assertion fails, the inode structure does not pack
+     exactly into a sector, and you should fix that. */
+  ASSERT (sizeof *disk_inode == BLOCK_SECTOR_SIZE / INODES_PER_SECTOR);
 
-  disk_inode = calloc (1, sizeof *disk_inode); //Now we need to format the inode on disk
+  disk_inode = calloc (1, sizeof *disk_inode);
   if (disk_inode != NULL)
     {
-      size_t sectors = bytes_to_sectors (length); //Takes the file length and determines how many sectors need to be allocated
-      disk_inode->length = 0; // Set the length to 0, as well will "expand it" with actual given length
-      disk_inode->magic = INODE_MAGIC; //hello
+      disk_inode->length = length;
+      disk_inode->magic = INODE_MAGIC;
       disk_inode->type_dir = type_dir;
       disk_inode->parent = parent_sector;
+      success = true;
 
-    disk_inode->indirect_ptr = 0;
-    disk_inode->db_indirect_ptr = 0;
-    disk_inode->numDirect = 0; //To show no blocks have been written to, already setup since using local variable
-    disk_inode->numIndirect = 0; // To show indirect have not been used at all, thus not setup
-    disk_inode->numDbIndirect = 0; // To show dbl_indirect have not been used at all, thus not setup
-    if (inode_expand(disk_inode, length, true)) { //If we allocated to the disk properly
-    disk_inode->length = length;
-    block_write(fs_device, sector, disk_inode); //Update the inode that is now on disk
-    success = true;
-    }
-  free(disk_inode); //We're done with the inode on disk, so let's free it
-    }
-  return success; //Whether allocation was successful or not, we need to return whether we were successful or not
-
-  
-
-    /*
-    for (int i = 0; i < DIRECT_BLOCK_SIZE; i++) { //This helps us determine if a block has been allocated or not
-    disk_inode->direct[i] = -1;
-    }
+      /* The free map is written through its own file, so all of
+         its sectors must exist up front: allocating one while
+         writing the free map would have to write the free map. */
+      if (sector == FREE_MAP_INODE)
+        {
+          size_t sectors = bytes_to_sectors (length);
+          size_t i;
 
-      for (int i = 0; i < sectors; i++) { //You know how many sectors need to be allocated 
-        { for (int j = 0; j < DIRECT_BLOCK_SIZE; j++) {
-       if (disk_inode->direct[j] == -1) { //Check that we are writing to a free entry
-        free_map_allocate(1, &disk_inode->direct[j]); //Now we just allocate a sector and the direct table holds a pointer to the allocated sector
-        length = length - 512; //Every allocation means we have taken care of 512 of the bytes that need to be written to
-        if (length <= 0) {
-           break; //If there is no need to allocate more space, just stop allocating
+          for (i = 0; i < sectors && success; i++)
+            success = lookup_sector (disk_inode, i, true, NULL, 0) != 0;
         }
-       }
-      }
-     } //Now the direct block table is filled
-      if (length > 0) {
-      success = false; //We were not able to allocate enough
-      }
-      else { //Allocation was successful
-      success = true;
-      }
-      block_write(fs_device, sector, disk_inode); //And now we update the copy of the inode disk
-      */
-      //Will end up doing something similar for the indirect and double indirect pointers
-      /*
-          block_write (fs_device, sector, disk_inode);
-          if (sectors > 0) 
-            {
-              static char zeros[BLOCK_SECTOR_SIZE];
-              size_t i;
-              
-              for (i = 0; i < sectors; i++) 
-                block_write (fs_device, disk_inode->start + i, zeros);
-            }
-          success = true;
-        } 
+      else if (length <= INLINE_MAX)
+        disk_inode->inline_data = true;
+      if (success)
+        write_inode (sector, disk_inode);
       free (disk_inode);
-  }
-
-  return success; */
+    }
+  return success;
 }
 
 bool inode_edit_parent(block_sector_t parent_sector,
@@ -245,7 +675,10 @@ inode_open (block_sector_t sector)
   inode->open_cnt = 1;
   inode->deny_write_cnt = 0;
   inode->removed = false;
-  block_read (fs_device, inode->sector, &inode->data);
+  list_init (&inode->dirty);
+  inode->dirty_cnt = 0;
+  inode->child_table = 0;
+  read_inode (inode->sector, &inode->data);
   inode->length = inode->data.length; //The inode needs to know how long the corresponding data is
   inode->parent = inode->data.parent;
   inode->type_dir = inode->data.type_dir;
@@ -270,7 +703,8 @@ inode_get_inumber (const struct inode *inode)
 
 /* Closes INODE and writes it to disk.
    If this was the last reference to INODE, frees its memory.
-   If INODE was also a removed inode, frees its blocks. */
+   If INODE was also a removed inode, queues it for the reaper,
+   which frees its blocks in the background. */
 void
 inode_close (struct inode *inode) 
 {
@@ -280,11 +714,18 @@ inode_close (struct inode *inode)
 
   bool list_remove_inode = false;
   bool removed = false;
+  journal_begin ();
   /* Release resources if this was the last opener. */
   if (--inode->open_cnt == 0)
     {
       /* Remove from inode list and release lock. */
       list_remove_inode = true;
+      /* Write back dirty sectors, unless the inode is going
+         away. */
+      if (inode->removed)
+        discard_dirty_sectors (inode);
+      else
+        flush_dirty_sectors (inode);
       /* Deallocate blocks if removed. */
       if (inode->removed) 
       {
@@ -292,25 +733,6 @@ inode_close (struct inode *inode)
         printf("Deleting inode %p sector %d\n", inode, inode->sector);
         #endif
           removed = true;
-        
-         for (int i = 0; i < inode->data.numDirect; i++) {
-          free_map_release(inode->data.direct[i], 1); //Just deallocate all the direct blocks
-         }
-     
-         struct indirect_block block;
-
-         for(int j = 0; j < INDIRECT_BLOCK_SIZE; j++)
-         {
-          block.ind_ptrs[j] = 0;
-         }
-         if(inode->data.indirect_ptr > 0)
-         {
-           block_read(fs_device, inode->data.indirect_ptr, &block);
-           for (int j = 0; j < inode->data.numIndirect; j++) {
-            free_map_release(block.ind_ptrs[j], 1); //Just deallocate all the direct blocks
-           }
-         } 
-         free_map_release (inode->sector, 1);
       }
 
      }
@@ -319,12 +741,14 @@ inode_close (struct inode *inode)
 
     
 
-    // If not marked for deletion, save the state
-    if(!removed){ //Save the state of the disk_inode to disk regardless, but only if it hasn't been deleted aka removed
+    // Save the state of the disk_inode to disk, even if removed, so the reaper sees its final block pointers
     inode->data.parent = inode->parent;
     ASSERT(inode->length == inode->data.length);
-    block_write(fs_device, inode->sector, &inode->data); //This writes the state of the latest copy of the disk_inode to disk
-    }
+    write_inode(inode->sector, &inode->data); //This writes the state of the latest copy of the disk_inode to disk
+
+    // Hand a removed inode to the reaper once no one has it open
+    if(removed)
+      reaper_queue(inode->sector);
 
     // Remove the inode from the inode list if
     // the last opener has closed it
@@ -334,7 +758,37 @@ inode_close (struct inode *inode)
       list_remove (&inode->elem);
       free(inode);
     }
+    journal_commit ();
+}
+
+/* Returns true if inode number INUMBER is a directory, without
+   opening it. */
+bool
+inode_is_dir (block_sector_t inumber) 
+{
+  struct inode_disk disk_inode;
+  struct list_elem *e;
 
+  for (e = list_begin (&open_inodes); e != list_end (&open_inodes);
+       e = list_next (e)) 
+    {
+      struct inode *inode = list_entry (e, struct inode, elem);
+      if (inode->sector == inumber) 
+        return inode->type_dir;
+    }
+  read_inode (inumber, &disk_inode);
+  return disk_inode.type_dir;
+}
+
+/* Fills in ST with INODE's metadata. */
+void
+inode_stat (const struct inode *inode, struct stat *st) 
+{
+  st->st_ino = inode->sector;
+  st->st_size = inode_length (inode);
+  st->st_isdir = inode->type_dir;
+  st->st_blocks = inode->data.sector_cnt;
+  st->st_parent = inode->parent;
 }
 
 /* Marks INODE to be deleted when it is closed by the last caller who
@@ -343,63 +797,26 @@ void
 inode_remove (struct inode *inode) 
 {
   ASSERT (inode != NULL);
+  if (!inode->removed)
+    reaper_orphan (inode->sector);
   inode->removed = true;
 }
 
-int inode_actual_length(struct inode *inode) {
-  int direct_sectors = inode->data.numDirect;
-  int indirect_sectors = inode->data.numIndirect >= 0? inode->data.numIndirect : 0;
-  int indbindirect_sectors = inode->data.numDbIndirect >= 0? inode->data.numDbIndirect : 0;
-  int total_blocks_from_db_indirect = 0;
-
-
-  // Caculate number of data blocks from double_indirect_block
-  if(indbindirect_sectors > 0)
-  {
-
-    struct indirect_block block;
-    for(int i = 0; i < INDIRECT_BLOCK_SIZE; i++)
-    {
-      block.ind_ptrs[i] = 0;
-    }
+/* Frees the blocks and the inode of removed inode INUMBER, which
+   must not be open. */
+void
+inode_reclaim (block_sector_t inumber) 
+{
+  struct inode_disk disk_inode;
 
-    if(inode->data.db_indirect_ptr > 0)
+  journal_begin ();
+  read_inode (inumber, &disk_inode);
+  if (disk_inode.magic == INODE_MAGIC)
     {
-
-      // Read the double block to get the pointers
-      block_read(fs_device, inode->data.db_indirect_ptr, &block);
-      for(int i = 0; i < INDIRECT_BLOCK_SIZE; i++)
-      {
-        // check if double block pointer is valid i
-        if(block.ind_ptrs[i] > 0)
-        {
-
-            struct indirect_block block_ind;
-            for(int i = 0; i < INDIRECT_BLOCK_SIZE; i++)
-              block_ind.ind_ptrs[i] = 0;
-
-            block_read(fs_device, block.ind_ptrs[i], &block_ind);
-
-            // calculate the number of sectors/datablocks
-            // in this indirect_block
-            for(int i = 0; i < INDIRECT_BLOCK_SIZE; i++)
-            {
-              // check if indirect pointer is valid 
-              if(block_ind.ind_ptrs[i] > 0)
-              {
-                total_blocks_from_db_indirect = total_blocks_from_db_indirect + 1;
-              }
-            }
-        }
-      }
-    } else
-    {
-      return -1;
+      release_tail (&disk_inode, 0);
+      inode_release (inumber);
     }
-  }
-
-  int inode_actual_size = direct_sectors*BLOCK_SECTOR_SIZE + indirect_sectors*BLOCK_SECTOR_SIZE + total_blocks_from_db_indirect*BLOCK_SECTOR_SIZE; // TODO, add db_indirect
-  return inode_actual_size;
+  journal_commit ();
 }
 
 /* Reads SIZE bytes from INODE into BUFFER, starting at position OFFSET.
@@ -416,31 +833,46 @@ inode_read_at (struct inode *inode, void *buffer_, off_t size, off_t offset)
   return 0; //Return a 0 as no bytes could be read
   }
 
-  #ifdef INODE_DEBUG
-  printf("inode_read: inode->length %d size %d, offset %d numDirect %d numIndirect %d numDbIndrect %d\n", inode->length, size, offset,inode->data.numDirect, inode->data.numIndirect, inode->data.numDbIndirect);
-  #endif
+  if (inode->data.inline_data)
+    {
+      ASSERT (offset >= 0 && size >= 0);
+      memcpy (buffer, (uint8_t *) inode->data.direct + offset, size);
+      return size;
+    }
+
   while (size > 0) 
     {
-      /* Disk sector to read, starting byte offset within sector. */ 
-      block_sector_t sector_idx = byte_to_sector (inode, inode_actual_length(inode), offset);
+      /* Dirty copy or disk sector to read, starting byte offset
+         within sector. */ 
+      struct dirty_sector *ds
+        = find_dirty_sector (inode, offset / BLOCK_SECTOR_SIZE);
+      block_sector_t sector_idx = ds == NULL ? byte_to_sector (inode, offset) : 0;
       int sector_ofs = offset % BLOCK_SECTOR_SIZE;
 
       /* Bytes left in inode, bytes left in sector, lesser of the two. */
-      off_t inode_left = inode_actual_length(inode) - offset;
+      off_t inode_left = inode_length (inode) - offset;
       int sector_left = BLOCK_SECTOR_SIZE - sector_ofs;
       int min_left = inode_left < sector_left ? inode_left : sector_left;
-  #ifdef INODE_DEBUG
-      printf(" sector_idx %d\n sector_ofs %d\n inode_left %d\n sector_left %d\n min_left %d size %d\n", sector_idx, sector_ofs, inode_left, sector_left, min_left, size);
-      #endif
+
       /* Number of bytes to actually copy out of this sector. */
       int chunk_size = size < min_left ? size : min_left;
       if (chunk_size <= 0)
         break;
 
-      if (sector_ofs == 0 && chunk_size == BLOCK_SECTOR_SIZE)
+      if (ds != NULL)
+        {
+          /* Written but not yet flushed. */
+          memcpy (buffer + bytes_read, ds->data + sector_ofs, chunk_size);
+        }
+      else if (sector_idx == 0)
+        {
+          /* Holes read as zeros without touching the disk. */
+          memset (buffer + bytes_read, 0, chunk_size);
+        }
+      else if (sector_ofs == 0 && chunk_size == BLOCK_SECTOR_SIZE)
         {
           /* Read full sector directly into caller's buffer. */
-          block_read (fs_device, sector_idx, buffer + bytes_read);
+          read_data (inode, sector_idx, buffer + bytes_read);
         }
       else 
         {
@@ -452,7 +884,7 @@ inode_read_at (struct inode *inode, void *buffer_, off_t size, off_t offset)
               if (bounce == NULL)
                 break;
             }
-          block_read (fs_device, sector_idx, bounce);
+          read_data (inode, sector_idx, bounce);
           memcpy (buffer + bytes_read, bounce + sector_ofs, chunk_size);
         }
       
@@ -462,16 +894,60 @@ inode_read_at (struct inode *inode, void *buffer_, off_t size, off_t offset)
       bytes_read += chunk_size;
     }
   free (bounce);
-// printf(" Inode read bytes read %d", bytes_read);
   return bytes_read;
+}
+
+/* Moves INODE's data out of the inode into data sectors, because
+   it is about to grow past INLINE_MAX bytes.  Returns true if
+   successful, false if memory or disk allocation fails. */
+static bool
+move_inline_data (struct inode *inode)
+{
+  off_t length = inode->data.length;
+  uint8_t *data = malloc (INLINE_MAX);
+  bool success;
+
+  if (data == NULL)
+    return false;
+  memcpy (data, inode->data.direct, INLINE_MAX);
+  memset (inode->data.direct, 0, INLINE_MAX);
+  inode->data.inline_data = false;
+  success = inode_write_at (inode, data, length, 0) == length;
+  free (data);
+  return success;
+}
+
+/* Zeros the sectors that inode_reserve() allocated past INODE's
+   end of file, up to the one that holds byte LENGTH - 1, because
+   INODE is about to grow to LENGTH bytes and they must read as
+   zeros, like the holes they stand in for.  Sectors past end of
+   file are otherwise never written, so a reserved sector still
+   holds whatever it held before. */
+static void
+zero_past_eof (struct inode *inode, off_t length)
+{
+  static char zeros[BLOCK_SECTOR_SIZE];
+  size_t idx;
 
+  if (!inode->data.prealloc)
+    return;
+  for (idx = bytes_to_sectors (inode->data.length);
+       idx < bytes_to_sectors (length); idx++)
+    {
+      block_sector_t sector = lookup_sector (&inode->data, idx, false, NULL, 0);
+      if (sector != 0)
+        write_data (inode, sector, zeros);
+    }
 }
 
 /* Writes SIZE bytes from BUFFER into INODE, starting at OFFSET.
    Returns the number of bytes actually written, which may be
-   less than SIZE if end of file is reached or an error occurs.
-   (Normally a write at end of file would extend the inode, but
-   growth is not yet implemented.) */
+   less than SIZE if the disk fills up or an error occurs.
+   Writing past end of file extends the inode; only the sectors
+   actually written are allocated, so any gap between the old
+   end of file and OFFSET is left as a hole.  Writes to file data
+   are buffered in memory until inode_flush() or the last close,
+   and holes are not given disk space until then. */
 off_t
 inode_write_at (struct inode *inode, const void *buffer_, off_t size,
                 off_t offset) 
@@ -479,377 +955,389 @@ inode_write_at (struct inode *inode, const void *buffer_, off_t size,
   const uint8_t *buffer = buffer_;
   off_t bytes_written = 0;
   uint8_t *bounce = NULL;
-  int offset_copy = offset;
 
   if (inode->deny_write_cnt)
     return 0;
 
+  if (inode->data.inline_data)
+    {
+      ASSERT (offset >= 0 && size >= 0);
+      if (offset + size <= INLINE_MAX)
+        {
+          memcpy ((uint8_t *) inode->data.direct + offset, buffer, size);
+          if (offset + size > inode->data.length)
+            {
+              inode->data.length = offset + size;
+              inode->length = offset + size;
+            }
+          write_inode (inode->sector, &inode->data);
+          return size;
+        }
+      if (!move_inline_data (inode))
+        return 0;
+    }
 
-
-  int inode_actual_size = inode_actual_length(inode);
-  // Update the length if we have not gone past the file's actual size
-  if(inode->data.length  < inode_actual_size && ( (offset + size) > inode->data.length && (offset + size)  <= inode_actual_size)  )
-  {
-    inode->length = offset_copy + size;
-    #ifdef INODE_DEBUG
-    printf("inode->length %d\n", inode->length);
-    #endif
-    inode->data.length = inode->length;
-  }
-  #ifdef INODE_DEBUG
-  printf(" about to expand...  actua_size %d offest %d size %d inode->data.length %d inode->length %d\n",  inode_actual_size, offset, size, inode->data.length, inode->length);
-  #endif
-
-  if (offset + size > inode_actual_size) { //If you are writing to a point past the inode
-    #ifdef INODE_DEBUG
-  printf("Condition met to expand , offset %d size %d inode_length %d\n", offset, size, inode_length(inode));
-  #endif
-  inode_expand(&inode->data, offset + size - inode->data.length, false); //Now you must extend the inode that exists before writing to it and alos update the length of the inode
-  inode->data.length += offset + size - inode->data.length;
-  inode->length = inode->data.length;
-  inode_actual_size = inode_actual_length(inode);
-  #ifdef INODE_DEBUG
-  printf("Done expanding %d\n", inode->length);
-  #endif
-  }
-  #ifdef INODE_DEBUG
-  printf("Now Writing... ");
-  #endif
+  journal_begin ();
+  if (offset > inode->data.length)
+    zero_past_eof (inode, offset);
   while (size > 0) 
     {
-      /* Sector to write, starting byte offset within sector. */
-      block_sector_t sector_idx = byte_to_sector (inode, inode_actual_size, offset);
+      /* Starting byte offset within sector, bytes to actually
+         write into this sector. */
       int sector_ofs = offset % BLOCK_SECTOR_SIZE;
-      #ifdef INODE_DEBUG
-      printf("%d sector ofs offset %d", sector_ofs, offset);
-      #endif
-      /* Bytes left in inode, bytes left in sector, lesser of the two. */
-      off_t inode_left = inode_actual_size - offset;
       int sector_left = BLOCK_SECTOR_SIZE - sector_ofs;
-      int min_left = inode_left < sector_left ? inode_left : sector_left;
-  #ifdef INODE_DEBUG
-      printf(" sector_idx %d\n sector_ofs %d\n inode_left %d\n sector_left %d\n min_left %d\n", sector_idx, sector_ofs, inode_left, sector_left, min_left);
-      #endif
-      /* Number of bytes to actually write into this sector. */
-      int chunk_size = size < min_left ? size : min_left;
-      if (chunk_size <= 0)
-        break;
+      int chunk_size = size < sector_left ? size : sector_left;
+      bool partial = sector_ofs > 0 || chunk_size < BLOCK_SECTOR_SIZE;
+
+      /* A sector wholly past end of file is a hole or was reserved
+         by inode_reserve(), and either way starts out as zeros. */
+      bool past_eof = offset - sector_ofs >= inode->data.length;
+
+      /* File data is written into a dirty copy of the sector, to
+         be flushed later.  A hole is not allocated until then.
+         Metadata goes straight to the journal, which buffers it
+         itself. */
+      size_t idx = offset / BLOCK_SECTOR_SIZE;
+      block_sector_t sector_idx = byte_to_sector (inode, offset);
+      struct dirty_sector *ds = NULL;
+      if (!is_metadata (inode))
+        {
+          ds = find_dirty_sector (inode, idx);
+          if (ds == NULL)
+            ds = add_dirty_sector (inode, idx, sector_idx,
+                                   partial && !past_eof);
+        }
 
-      if (sector_ofs == 0 && chunk_size == BLOCK_SECTOR_SIZE)
+      if (ds != NULL)
         {
-          /* Write full sector directly to disk. */
-          block_write (fs_device, sector_idx, buffer + bytes_written);
+          memcpy (ds->data + sector_ofs, buffer + bytes_written, chunk_size);
         }
-      else 
+      else
         {
-          /* We need a bounce buffer. */
-          if (bounce == NULL) 
+          /* A partial write needs a bounce buffer.  Get it before
+             allocating the sector, which is not zeroed yet. */
+          if (partial && bounce == NULL) 
             {
               bounce = malloc (BLOCK_SECTOR_SIZE);
               if (bounce == NULL)
                 break;
             }
 
-          /* If the sector contains data before or after the chunk
-             we're writing, then we need to read in the sector
-             first.  Otherwise we start with a sector of all zeros. */
-          if (sector_ofs > 0 || chunk_size < sector_left) 
-            block_read (fs_device, sector_idx, bounce);
-          else
-            memset (bounce, 0, BLOCK_SECTOR_SIZE);
-          memcpy (bounce + sector_ofs, buffer + bytes_written, chunk_size);
-          block_write (fs_device, sector_idx, bounce);
+          /* Sector to write, allocated now if it could not be
+             buffered. */
+          bool fresh = false;
+          if (sector_idx == 0)
+            sector_idx = lookup_sector (&inode->data, idx, true, &fresh, 0);
+          if (sector_idx == 0)
+            break;
+
+          if (!partial)
+            {
+              /* Write full sector directly to disk. */
+              write_data (inode, sector_idx, buffer + bytes_written);
+            }
+          else 
+            {
+              /* If the sector was already allocated, it holds data
+                 before or after the chunk we're writing, so read it
+                 in first.  Otherwise we start with a sector of all
+                 zeros. */
+              if (!fresh && !past_eof)
+                read_data (inode, sector_idx, bounce);
+              else
+                memset (bounce, 0, BLOCK_SECTOR_SIZE);
+              memcpy (bounce + sector_ofs, buffer + bytes_written, chunk_size);
+              write_data (inode, sector_idx, bounce);
+            }
         }
 
       /* Advance. */
       size -= chunk_size;
       offset += chunk_size;
       bytes_written += chunk_size;
-      #ifdef INODE_DEBUG
-      printf("end while size %d\n", offset);
-      #endif
     }
   free (bounce);
 
-    #ifdef INODE_DEBUG
-    printf("inode->length %d\n", inode->length);
-    #endif
-
+  /* Extend the file over what was written. */
+  if (offset > inode->data.length)
+    {
+      inode->data.length = offset;
+      inode->length = offset;
+    }
+  journal_commit ();
   return bytes_written;
-
-}
-
-/* Disables writes to INODE.
-   May be called at most once per inode opener. */
-void
-inode_deny_write (struct inode *inode) 
-{
-  inode->deny_write_cnt++;
-  ASSERT (inode->deny_write_cnt <= inode->open_cnt);
 }
 
-/* Re-enables writes to INODE.
-   Must be called once by each inode opener who has called
-   inode_deny_write() on the inode, before closing the inode. */
-void
-inode_allow_write (struct inode *inode) 
-{
-  ASSERT (inode->deny_write_cnt > 0);
-  ASSERT (inode->deny_write_cnt <= inode->open_cnt);
-  inode->deny_write_cnt--;
-}
-
-/* Returns the length, in bytes, of INODE's data. */
-off_t
-inode_length (const struct inode *inode)
-{
-  return inode->data.length;
-}
-
-
-bool allocate_indirect(struct inode_disk* inode, 
-  block_sector_t double_block_sector,
-  int double_block_sector_index,
-  int num_ind_sectors,
-  bool new_double_block_time,
-  struct indirect_block* db_block)
+/* Sets INODE's length to LENGTH bytes.  Shrinking frees every
+   sector past the new end of file, including any reserved by
+   inode_reserve(), in one batch; growing leaves a hole.  Returns
+   true if successful, false if writes to INODE are denied or
+   memory or disk allocation fails. */
+bool
+inode_truncate (struct inode *inode, off_t length)
 {
+  static char zeros[BLOCK_SECTOR_SIZE];
+  off_t old_length = inode->data.length;
 
+  if (inode->deny_write_cnt || length < 0)
+    return false;
+  if (inode->data.inline_data && length > INLINE_MAX
+      && !move_inline_data (inode))
+    return false;
 
-  // allocate a double block 
-  if(new_double_block_time)
-  {
-    free_map_allocate(1, &db_block->ind_ptrs[inode->numDbIndirect]);
-    inode->numDbIndirect = inode->numDbIndirect + 1;
-    // update the inode_disk since numDbIndirect was increased
-    block_write(fs_device, inode->db_indirect_ptr, db_block);
-    double_block_sector = db_block->ind_ptrs[inode->numDbIndirect -1];
-  }
-
-  struct indirect_block ind_block; //This is for implementing indirect blocks
-  for (int j = 0; j < INDIRECT_BLOCK_SIZE; j++) {
-    ind_block.ind_ptrs[j] = 0; //This will clean the junk inside the array of pointers
-  }
-
-  // Now allocate the number of leftover sectors inside the double block
-  if(new_double_block_time)
-  for(int k = 0; k < num_ind_sectors; k++)
-  {
-    free_map_allocate(1, &ind_block.ind_ptrs[k]);
-  }
-
-  else {
-
-      block_read(fs_device, double_block_sector, &ind_block);
-    for(int i = 0; i < num_ind_sectors; i++)
+  journal_begin ();
+  if (inode->data.inline_data)
     {
-      free_map_allocate(1, &ind_block.ind_ptrs[i+double_block_sector_index]);
+      if (length < old_length)
+        memset ((uint8_t *) inode->data.direct + length, 0,
+                old_length - length);
     }
-  }
-  // Write the new double block into filesystem
-  if(num_ind_sectors > 0)
-  block_write(fs_device, double_block_sector, &ind_block);
-
-  bool success = true;
+  else if (length <= old_length)
+    {
+      /* Zero the rest of the new last sector, so that it reads as
+         zeros if the file grows again. */
+      size_t keep = bytes_to_sectors (length);
+      off_t end = ROUND_UP (length, BLOCK_SECTOR_SIZE);
+      if (end > old_length)
+        end = old_length;
+      if (length % BLOCK_SECTOR_SIZE != 0
+          && (byte_to_sector (inode, length) != 0
+              || find_dirty_sector (inode, length / BLOCK_SECTOR_SIZE)))
+        inode_write_at (inode, zeros, end - length, length);
+
+      discard_dirty_tail (inode, keep);
+      release_tail (&inode->data, keep);
+      inode->data.prealloc = false;
+    }
+  else
+    zero_past_eof (inode, length);
 
-  return success;
+  inode->data.length = length;
+  inode->length = length;
+  write_inode (inode->sector, &inode->data);
+  journal_commit ();
+  return true;
 }
 
+/* Gives disk space to the holes in bytes OFFSET through
+   OFFSET + SIZE - 1 of INODE, so that later writes there need not
+   allocate.  Each run of holes is placed in as few runs of
+   consecutive free sectors as the free map allows.  INODE's
+   length does not change: sectors past end of file are left as
+   they are on disk until the file grows over them, so reserving
+   space for a file that is about to be written costs no extra
+   writes.  Returns true if successful, false if writes to INODE
+   are denied or the disk fills up, in which case some of the
+   space may have been reserved anyway. */
+bool
+inode_reserve (struct inode *inode, off_t offset, off_t size)
+{
+  static char zeros[BLOCK_SECTOR_SIZE];
+  size_t idx, end;
+  bool success = true;
 
-    bool inode_db_indirect_fun_time(block_sector_t sectors, struct inode_disk * inode) {
+  if (inode->deny_write_cnt || offset < 0 || size < 0)
+    return false;
+  if (inode->data.inline_data)
+    {
+      if (offset + size <= INLINE_MAX)
+        return true;
+      if (!move_inline_data (inode))
+        return false;
+    }
 
-      bool success= true;
-      ASSERT(sectors > 0);
-    
-    struct indirect_block db_block; //This is for implementing indirect blocks
-    for (int j = 0; j < INDIRECT_BLOCK_SIZE; j++) {
-      db_block.ind_ptrs[j] = 0; //This will clean the junk inside the array of pointers
-    }
-    #ifdef INODE_DEBUG
-    printf("Double Indirect Expansion\n");
-    #endif
-      // Either create a new db_indirect_block or read from an existing one
-      if(inode->db_indirect_ptr <= 0) {
-        free_map_allocate(1, &inode->db_indirect_ptr);
-      }
-      else {
-      block_read(fs_device, inode->db_indirect_ptr, &db_block); //Otherwise read the indirect block into the filesystem
-      }
+  journal_begin ();
 
-      // From the sectors needed to allocate, determine the
-      // num of double blocks and any leftover
-      // indirect blocks needed
-      int num_db_sectors = sectors / INDIRECT_BLOCK_SIZE; 
-      int num_ind_sectors = sectors % INDIRECT_BLOCK_SIZE;
-      #ifdef INODE_DEBUG
-      printf("num_db_sectors %d num_ind_sectors %d\n", num_db_sectors, num_ind_sectors);
-      #endif
-      if(num_db_sectors > (INDIRECT_BLOCK_SIZE - inode->numDbIndirect))
-        return false;
+  /* Buffered writes into holes get their sectors first, so that
+     the holes left are all real. */
+  flush_dirty_sectors (inode);
 
+  idx = offset / BLOCK_SECTOR_SIZE;
+  end = bytes_to_sectors (offset + size);
+  while (idx < end)
+    {
+      block_sector_t start;
+      size_t cnt, i;
 
-      // Allocate the number of double blocks needed
-      for(int k = 0; k < num_db_sectors; k++)
-      {
-        free_map_allocate(1, &db_block.ind_ptrs[inode->numDbIndirect]);
-        struct indirect_block ind_block; //This is for implementing indirect blocks
-        for (int j = 0; j < INDIRECT_BLOCK_SIZE; j++) {
-          ind_block.ind_ptrs[j] = 0; //This will clean the junk inside the array of pointers
+      if (lookup_sector (&inode->data, idx, false, NULL, 0) != 0)
+        {
+          idx++;
+          continue;
         }
-
-        for(int k = 0; k < INDIRECT_BLOCK_SIZE; k++)
+      for (cnt = 1; idx + cnt < end && cnt < RESERVE_RUN; cnt++)
+        if (lookup_sector (&inode->data, idx + cnt, false, NULL, 0) != 0)
+          break;
+      while (cnt > 0 && !free_map_allocate (cnt, &start))
+        cnt /= 2;
+      if (cnt == 0)
         {
-          free_map_allocate(1, &ind_block.ind_ptrs[k]);
-          inode->numDbIndirect = inode->numDbIndirect + 1;
+          success = false;
+          break;
         }
 
-        block_write(fs_device, db_block.ind_ptrs[inode->numDbIndirect], &ind_block);
-        inode->numDbIndirect = inode->numDbIndirect + 1;
-      }
-
-      // update the inode_disk if numDbIndirect was increased
-      if(num_db_sectors > 0)
-      {
-        block_write(fs_device, inode->db_indirect_ptr, &db_block);
-      }
-
-      bool new_double_block_time = true;
-      block_sector_t double_block_sector = 0;
-      int double_block_sector_index = -1;
-      // Figure out which double block to use, do we need to make a new one?
-      if(num_db_sectors <= 0)
-      for(int i = 0; i < inode->numDbIndirect; i++)
-      {
-        struct indirect_block ind_block; //This is for implementing indirect blocks
-        for (int j = 0; j < INDIRECT_BLOCK_SIZE; j++) {
-          ind_block.ind_ptrs[j] = 0; //This will clean the junk inside the array of pointers
+      for (i = 0; i < cnt; i++, idx++)
+        {
+          bool fresh;
+          if (lookup_sector (&inode->data, idx, true, &fresh, start + i) == 0)
+            break;
+
+          /* Within the file, the hole read as zeros, so the sector
+             must too. */
+          if ((off_t) idx * BLOCK_SECTOR_SIZE < inode->data.length)
+            write_data (inode, start + i, zeros);
+          else
+            inode->data.prealloc = true;
         }
-        block_read(fs_device, db_block.ind_ptrs[i], &ind_block);
-
-        int p = 0;
-        while(ind_block.ind_ptrs[p] > 0 && p<INDIRECT_BLOCK_SIZE)
-          p++;
-
-
-
-        if(p < INDIRECT_BLOCK_SIZE && ind_block.ind_ptrs[p] == 0)
+      if (i < cnt)
         {
-
-          if( (p + num_ind_sectors) > INDIRECT_BLOCK_SIZE)
-          {
-            success = allocate_indirect( inode,
-              double_block_sector,
-              double_block_sector_index,
-              INDIRECT_BLOCK_SIZE - p,
-              false,
-              &db_block);
-
-              num_ind_sectors -= (INDIRECT_BLOCK_SIZE-p);
-
-              new_double_block_time = true;
-            }
-
-          
-          double_block_sector = db_block.ind_ptrs[i];
-          double_block_sector_index = p;
-          new_double_block_time = false;
+          free_map_release (start + i, cnt - i);
+          success = false;
           break;
-         }
-       }
-        
+        }
 
-      
-      #ifdef INODE_DEBUG
-      printf("Double Block Sector %d, P %d last sector %d \n", double_block_sector, double_block_sector_index, db_block.ind_ptrs[0]);
-      #endif
+      /* The run is in place, so a large reservation may commit
+         here and go on in a new group. */
+      write_inode (inode->sector, &inode->data);
+      journal_checkpoint ();
+    }
 
+  write_inode (inode->sector, &inode->data);
+  journal_commit ();
+  return success;
+}
 
+/* Returns the number of runs of consecutive disk sectors that
+   hold INODE's data, taken in file order and skipping holes, so
+   that 1 means the file is contiguous.  Stores the number of
+   data sectors into *CNT and the first of them into *FIRST.
+   Sectors reserved past end of file are not counted. */
+size_t
+inode_extents (struct inode *inode, size_t *cnt, block_sector_t *first)
+{
+  size_t end = bytes_to_sectors (inode->data.length);
+  size_t extents = 0;
+  block_sector_t prev = 0;
+  size_t idx;
+
+  *cnt = 0;
+  *first = 0;
+  if (inode->data.inline_data)
+    return 0;
+  for (idx = 0; idx < end; idx++)
+    {
+      block_sector_t sector = lookup_sector (&inode->data, idx, false, NULL, 0);
+      if (sector == 0)
+        continue;
+      if (*cnt == 0)
+        *first = sector;
+      else if (sector == prev + 1)
+        extents--;
+      extents++;
+      prev = sector;
+      ++*cnt;
+    }
+  return extents;
+}
 
-     return allocate_indirect( inode, 
-        double_block_sector,
-        double_block_sector_index,
-        num_ind_sectors,
-        new_double_block_time,
-        &db_block);
-      }
+/* Moves up to CNT of INODE's data sectors, starting with file
+   sector *IDX and skipping holes, to the consecutive disk sectors
+   starting at DEST, which the caller has allocated.  Each sector
+   is copied before the pointers are rewritten, and the pointers
+   are rewritten and the old sectors freed within one journal
+   transaction, so a crash leaves the file either all in its old
+   place or all in its new one.  Advances *IDX past the last
+   sector moved and returns the number moved, which is less than
+   CNT only if end of file is reached. */
+size_t
+inode_relocate (struct inode *inode, size_t *idx, block_sector_t dest,
+                size_t cnt)
+{
+  size_t end = bytes_to_sectors (inode->data.length);
+  block_sector_t *old;
+  uint8_t *buffer;
+  size_t moved = 0;
 
-bool inode_expand(struct inode_disk *inode, off_t length, bool create) { //This will be the function to expand the blocks needed in inode_create
+  if (inode->data.inline_data)
+    return 0;
+  old = malloc (cnt * sizeof *old);
+  buffer = malloc (BLOCK_SECTOR_SIZE);
+  if (old == NULL || buffer == NULL)
+    {
+      free (old);
+      free (buffer);
+      return 0;
+    }
 
-  #ifdef INODE_DEBUG
-  printf("Inode_Expand inode %p, length %d numDirect %d inode_length%d numIndirect %d numDbIndrect %d\n", inode, length, inode->numDirect, inode->length, inode->numIndirect, inode->numDbIndirect);
-  #endif
-  static char zeroes[BLOCK_SECTOR_SIZE]; //An array of zeroes to "clean" the sector data
-  int sectors = bytes_to_sectors (length);// - bytes_to_sectors(inode->length); //This determines the length by which you want to expand the current inode
-  int total_sectors = sectors; // save a copy of sectors
-  bool success = false;
+  journal_begin ();
 
-  int i = -1;
-  int old_numDirect = inode->numDirect;
-  for (i = inode->numDirect; i < DIRECT_BLOCK_SIZE; i++) { //This is where we actually allocate the sectors
-  i = inode->numDirect; //Start at the next free block
-  if (sectors > 0) { //If there are still sectors to allocate
-   //Well, let's allocate!
-    #ifdef INODE_DEBUG
-    printf("inode expand: Direct expanding at %d\n", i);
-    #endif
-   free_map_allocate(1, &inode->direct[i]); //Now we just allocate a sector and the direct table holds a pointer to the allocated sector
-   block_write(fs_device, inode->direct[i], zeroes); //Now clean what is inside the allocated sector
-   sectors--; //We know a sector has been allocated
-   inode->numDirect++; //Also increment the number of direct blocks allocated
-    }
-    if (sectors == 0) { //If the sectors are all allocated
-      success = true; //Then we allocated everything!
-     }
-    if (success) { //If we did allocate everything
-      //inode->length += length; // Length is updated by calling function
-      break;
-    }
-  }
-  #ifdef INODE_DEBUG
-  printf("success %d, sectors, %d, inode->numDirect %d\n", success, sectors, inode->numDirect);
-  #endif
-  if (!success && sectors != 0) { //Just direct pointers were not enough
+  /* Buffered writes would otherwise go to the old sectors. */
+  flush_dirty_sectors (inode);
 
-    struct indirect_block block; //This is for implementing indirect blocks
-    for (int j = 0; j < INDIRECT_BLOCK_SIZE; j++) {
-      block.ind_ptrs[j] = 0; //This will clean the junk inside the array of pointers
+  for (; moved < cnt && *idx < end; ++*idx)
+    {
+      block_sector_t sector = lookup_sector (&inode->data, *idx, false,
+                                             NULL, 0);
+      if (sector == 0)
+        continue;
+      read_data (inode, sector, buffer);
+      write_data (inode, dest + moved, buffer);
+      remap_sector (&inode->data, *idx, dest + moved);
+      old[moved++] = sector;
     }
+  free_map_release_batch (old, moved);
+  write_inode (inode->sector, &inode->data);
+  journal_commit ();
 
-    if (inode->indirect_ptr == 0) {
-      free_map_allocate(1, &inode->indirect_ptr); //Go ahead and allocate to the indirect block
-      //block_write(fs_device, inode->indirect_ptr, &block); //Let's also go ahead and write the initial state to disk
-    }
-    else { //Otherwise
-      block_read(fs_device, inode->indirect_ptr, &block); //Otherwise read the indirect block into the filesystem
-    }
+  free (old);
+  free (buffer);
+  return moved;
+}
 
-    for (int j = inode->numIndirect; j < INDIRECT_BLOCK_SIZE; j++) {
-      j = inode->numIndirect; //Start with the next free indirect block
-      if (sectors > 0) { //Now we can allocate indirect blocks
-      free_map_allocate(1, &block.ind_ptrs[j]); //So now we start allocating to the indirect block array
-      block_write(fs_device, block.ind_ptrs[j], zeroes); //Now clean what is inside the allocated sector
-      sectors--; //We know a sector has been allocated
-      inode->numIndirect++; //Also increment the number of indirect blocks allocated
-      }
-      if (sectors == 0 || (j+1) == INDIRECT_BLOCK_SIZE) { //If all the sectors were allocated
-      block_write(fs_device, inode->indirect_ptr, &block); //Now we write to disk
-      
-          if(sectors == 0)
-          {
-          success = true;
-          //inode->length += length; // Length is updated by calling function
-          }
-      break; //Get out of this loop
-      }
-    }
+/* Writes INODE's dirty sectors to disk, then INODE itself. */
+void
+inode_flush (struct inode *inode)
+{
+  journal_begin ();
+  flush_dirty_sectors (inode);
+  inode->data.parent = inode->parent;
+  write_inode (inode->sector, &inode->data);
+  journal_commit ();
+}
 
-    // double_indirect
-    if(success == false)
-      success = inode_db_indirect_fun_time( sectors, inode);
-    
+/* Flushes every open inode to disk. */
+void
+inode_flush_all (void)
+{
+  struct list_elem *e;
 
-      
-  } // end if (!success && sectors > 0)
+  for (e = list_begin (&open_inodes); e != list_end (&open_inodes);
+       e = list_next (e))
+    inode_flush (list_entry (e, struct inode, elem));
+}
 
-  return success;
-}
\ No newline at end of file
+/* Disables writes to INODE.
+   May be called at most once per inode opener. */
+void
+inode_deny_write (struct inode *inode) 
+{
+  inode->deny_write_cnt++;
+  ASSERT (inode->deny_write_cnt <= inode->open_cnt);
+}
+
+/* Re-enables writes to INODE.
+   Must be called once by each inode opener who has called
+   inode_deny_write() on the inode, before closing the inode. */
+void
+inode_allow_write (struct inode *inode) 
+{
+  ASSERT (inode->deny_write_cnt > 0);
+  ASSERT (inode->deny_write_cnt <= inode->open_cnt);
+  inode->deny_write_cnt--;
+}
+
+/* Returns the length, in bytes, of INODE's data. */
+off_t
+inode_length (const struct inode *inode)
+{
+  return inode->data.length;
+}
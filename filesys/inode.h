@@ -5,43 +5,51 @@
 #include "filesys/off_t.h"
 #include "devices/block.h"
 #include <list.h>
+#include <stat.h>
 
-#define DIRECT_BLOCK_SIZE 118
+#define DIRECT_BLOCK_SIZE 25
 #define INDIRECT_BLOCK_SIZE 128
 #define DBINDIRECT_BLOCK_SIZE 128
 
 
 struct bitmap;
 
+/* Number of on-disk inodes packed into each inode table sector.
+   Inode number N is slot N % INODES_PER_SECTOR of sector
+   N / INODES_PER_SECTOR. */
+#define INODES_PER_SECTOR 4
+
 /* On-disk inode.
-   Must be exactly BLOCK_SECTOR_SIZE bytes long. */
+   Must be exactly BLOCK_SECTOR_SIZE / INODES_PER_SECTOR bytes
+   long. */
 struct inode_disk
   {
-    block_sector_t start;               /* First data sector. */
     off_t length;                       /* File size in bytes. */
     block_sector_t parent;
     bool type_dir;
+    bool inline_data;                   /* Data stored in direct[]? */
+    bool prealloc;                      /* Sectors past EOF reserved? */
     unsigned magic;                     /* Magic number. */
-	uint32_t numDirect;					/* Number of allocated direct blocks */
-	uint32_t numIndirect;				/* Number of allocated indirect blocks */
-  uint32_t numDbIndirect;
-	block_sector_t direct[118];			/* Holds pointers to free sectors */
+	uint32_t sector_cnt;				/* Number of allocated data and indirect blocks */
+	block_sector_t direct[DIRECT_BLOCK_SIZE];	/* Holds pointers to free sectors */
 	block_sector_t indirect_ptr;		/* Holds a pointer to a sector that will point to free sectors */
 	block_sector_t db_indirect_ptr;	/* Points to a sector that points to a sector that points to free blocks (?) */
-    //uint32_t unused[120];             /* Not used. If you add a field, subtract one from the array size */
   };
 
 /* In-memory inode. */
 struct inode 
   {
     struct list_elem elem;              /* Element in inode list. */
-    block_sector_t sector;              /* Sector number of disk location. */
+    block_sector_t sector;              /* Inode number. */
     block_sector_t parent;
     bool type_dir;
     int open_cnt;                       /* Number of openers. */
     bool removed;                       /* True if deleted, false otherwise. */
     int deny_write_cnt;                 /* 0: writes ok, >0: deny writes. */
 	off_t length;						/* The same as the length in inode_disk, gets updated in inode_write and inode_create */
+    block_sector_t child_table;         /* Inode table sector of last child. */
+    struct list dirty;                  /* Unflushed data sectors, by index. */
+    size_t dirty_cnt;                   /* Number of elements in dirty. */
     struct inode_disk data;             /* Inode content. */
   };
 
@@ -51,16 +59,29 @@ struct indirect_block {
 
 
 void inode_init (void);
+bool inode_allocate (struct inode *parent, block_sector_t *);
+void inode_release (block_sector_t);
 bool inode_create (block_sector_t, off_t, bool type_dir, block_sector_t);
+bool inode_edit_parent (block_sector_t parent_sector, struct inode *child);
 struct inode *inode_open (block_sector_t);
 struct inode *inode_reopen (struct inode *);
 block_sector_t inode_get_inumber (const struct inode *);
 void inode_close (struct inode *);
 void inode_remove (struct inode *);
+void inode_reclaim (block_sector_t);
+bool inode_is_dir (block_sector_t);
+void inode_stat (const struct inode *, struct stat *);
 off_t inode_read_at (struct inode *, void *, off_t size, off_t offset);
 off_t inode_write_at (struct inode *, const void *, off_t size, off_t offset);
+bool inode_truncate (struct inode *, off_t length);
+bool inode_reserve (struct inode *, off_t offset, off_t size);
+size_t inode_extents (struct inode *, size_t *cnt, block_sector_t *first);
+size_t inode_relocate (struct inode *, size_t *idx, block_sector_t dest,
+                       size_t cnt);
 void inode_deny_write (struct inode *);
 void inode_allow_write (struct inode *);
 off_t inode_length (const struct inode *);
+void inode_flush (struct inode *);
+void inode_flush_all (void);
 
 #endif /* filesys/inode.h */
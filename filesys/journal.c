@@ -0,0 +1,359 @@
+#include "filesys/journal.h"
+#include <debug.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "filesys/filesys.h"
+#include "threads/malloc.h"
+#include "threads/synch.h"
+
+/* Write-ahead journal for file system metadata: inode sectors,
+   indirect blocks, and the data of directories and the free map.
+
+   Metadata writes made between journal_begin() and
+   journal_commit() are held in memory, where later writes to the
+   same sector replace earlier ones and reads see them.  Once no
+   operation is in progress and enough of them have built up, the
+   whole group is committed at once: the sectors are written
+   sequentially into the journal, then the header that lists them,
+   and only then to their home locations.  If the system crashes
+   before the header is written, none of the group reaches the
+   disk; if it crashes after, journal_init() replays the group.
+   Either way the file system's metadata stays consistent.
+
+   A group is never committed while an operation is in progress,
+   so each operation reaches the disk whole or not at all.  Every
+   operation that begins with none in progress starts with fewer
+   than JOURNAL_GROUP sectors pending, so it has room for the
+   rest; the few operations that can write more than that, like
+   reserving space for a large file, call journal_checkpoint()
+   between steps that leave the file system consistent. */
+
+/* Identifies a journal header. */
+#define JOURNAL_MAGIC 0x4a524e4c
+
+/* A group of operations is committed once it has this many
+   sectors, leaving room for the operations still in progress. */
+#define JOURNAL_GROUP (JOURNAL_ENTRIES / 2)
+
+/* On-disk journal header.
+   Must be exactly BLOCK_SECTOR_SIZE bytes long. */
+struct journal_header
+  {
+    unsigned magic;                     /* Magic number. */
+    uint32_t cnt;                       /* Number of sectors logged. */
+    block_sector_t sectors[JOURNAL_ENTRIES]; /* Home of each sector. */
+  };
+
+/* A metadata sector written but not yet committed. */
+struct journal_entry
+  {
+    block_sector_t sector;              /* Home location. */
+    uint8_t data[BLOCK_SECTOR_SIZE];    /* New contents. */
+  };
+
+static struct journal_entry **entries;  /* Pending writes. */
+static size_t entry_cnt;                /* Number of ENTRIES in use. */
+static size_t entry_max;                /* Number of ENTRIES allocated. */
+static int active_cnt;                  /* Operations in progress. */
+static unsigned group_no;               /* Number of the open group. */
+static bool flush_wanted;               /* Commit at the next chance? */
+static struct lock journal_lock;        /* Protects all of the above. */
+
+/* Statistics. */
+static long long commit_cnt;            /* Groups committed. */
+static long long logged_cnt;            /* Sectors written to journal. */
+static long long absorbed_cnt;          /* Writes merged into pending ones. */
+
+static void flush (void);
+
+/* Initializes the journal.  If FORMAT is true, the journal is
+   emptied; otherwise, a group that was committed but not yet
+   written to its home locations is replayed. */
+void
+journal_init (bool format)
+{
+  struct journal_header *h;
+  size_t i;
+
+  ASSERT (sizeof *h == BLOCK_SECTOR_SIZE);
+  lock_init (&journal_lock);
+
+  entry_max = JOURNAL_ENTRIES;
+  entries = malloc (entry_max * sizeof *entries);
+  if (entries == NULL)
+    PANIC ("can't allocate journal entries");
+
+  h = malloc (sizeof *h);
+  if (h == NULL)
+    PANIC ("can't allocate journal header");
+  block_read (fs_device, JOURNAL_SECTOR, h);
+  if (!format && h->magic == JOURNAL_MAGIC && h->cnt > 0
+      && h->cnt <= JOURNAL_ENTRIES)
+    {
+      uint8_t *buffer = malloc (BLOCK_SECTOR_SIZE);
+      if (buffer == NULL)
+        PANIC ("can't allocate journal buffer");
+      printf ("Replaying %u journal sectors...\n", (unsigned) h->cnt);
+      for (i = 0; i < h->cnt; i++)
+        {
+          block_read (fs_device, JOURNAL_SECTOR + 1 + i, buffer);
+          block_write (fs_device, h->sectors[i], buffer);
+        }
+      free (buffer);
+    }
+  memset (h, 0, sizeof *h);
+  h->magic = JOURNAL_MAGIC;
+  block_write (fs_device, JOURNAL_SECTOR, h);
+  free (h);
+}
+
+/* Commits any pending metadata writes. */
+void
+journal_done (void)
+{
+  journal_flush ();
+}
+
+/* Begins a file system operation.  Operations may nest.  If no
+   other operation is in progress, first commits the pending
+   writes if they leave less than half the journal free. */
+void
+journal_begin (void)
+{
+  lock_acquire (&journal_lock);
+  if (active_cnt++ == 0 && (entry_cnt >= JOURNAL_GROUP || flush_wanted))
+    flush ();
+  lock_release (&journal_lock);
+}
+
+/* Ends a file system operation begun with journal_begin().  When
+   no operations remain in progress and enough writes are pending,
+   commits them all as one group. */
+void
+journal_commit (void)
+{
+  lock_acquire (&journal_lock);
+  ASSERT (active_cnt > 0);
+  if (--active_cnt == 0 && (entry_cnt >= JOURNAL_GROUP || flush_wanted))
+    flush ();
+  lock_release (&journal_lock);
+}
+
+/* Marks a point within a long operation at which the file system
+   is consistent.  If no other operation is in progress and a
+   group has built up, commits it, so that the rest of the
+   operation has room in the journal. */
+void
+journal_checkpoint (void)
+{
+  lock_acquire (&journal_lock);
+  ASSERT (active_cnt > 0);
+  if (active_cnt == 1 && (entry_cnt >= JOURNAL_GROUP || flush_wanted))
+    flush ();
+  lock_release (&journal_lock);
+}
+
+/* Commits all pending metadata writes, whether or not a group
+   has built up. */
+void
+journal_flush (void)
+{
+  lock_acquire (&journal_lock);
+  flush ();
+  lock_release (&journal_lock);
+}
+
+/* Asks for the open group to be committed as soon as no
+   operation is in progress, whether or not it has built up. */
+void
+journal_request_flush (void)
+{
+  lock_acquire (&journal_lock);
+  flush_wanted = true;
+  lock_release (&journal_lock);
+}
+
+/* Returns the number of the open group, the one that the writes
+   made now will be committed in.  Once the number has changed,
+   every write made before the change is in its home location. */
+unsigned
+journal_group (void)
+{
+  unsigned group;
+
+  lock_acquire (&journal_lock);
+  group = group_no;
+  lock_release (&journal_lock);
+  return group;
+}
+
+/* Returns the pending entry for SECTOR, or a null pointer if
+   there is none. */
+static struct journal_entry *
+find_entry (block_sector_t sector)
+{
+  size_t i;
+
+  for (i = 0; i < entry_cnt; i++)
+    if (entries[i]->sector == sector)
+      return entries[i];
+  return NULL;
+}
+
+/* Reads metadata sector SECTOR into BUFFER, including any
+   pending write to it. */
+void
+journal_read (block_sector_t sector, void *buffer)
+{
+  struct journal_entry *e;
+
+  lock_acquire (&journal_lock);
+  e = find_entry (sector);
+  if (e != NULL)
+    memcpy (buffer, e->data, BLOCK_SECTOR_SIZE);
+  else
+    block_read (fs_device, sector, buffer);
+  lock_release (&journal_lock);
+}
+
+/* Writes BUFFER to metadata sector SECTOR as part of the current
+   group.  If the journal is full and no operation is in progress,
+   the group is committed first.  An operation in progress is
+   never split: the group grows past the journal's size instead,
+   and is committed in pieces when the operation ends, which
+   journal_checkpoint() keeps from happening in practice.  If
+   memory is exhausted, the sector is written in place. */
+void
+journal_write (block_sector_t sector, const void *buffer)
+{
+  struct journal_entry *e;
+
+  lock_acquire (&journal_lock);
+  e = find_entry (sector);
+  if (e != NULL)
+    absorbed_cnt++;
+  else
+    {
+      if (entry_cnt >= JOURNAL_ENTRIES && active_cnt == 0)
+        flush ();
+      if (entry_cnt >= entry_max)
+        {
+          struct journal_entry **bigger
+            = realloc (entries, 2 * entry_max * sizeof *entries);
+          if (bigger != NULL)
+            {
+              entries = bigger;
+              entry_max *= 2;
+            }
+        }
+      e = entry_cnt < entry_max ? malloc (sizeof *e) : NULL;
+      if (e == NULL)
+        {
+          block_write (fs_device, sector, buffer);
+          lock_release (&journal_lock);
+          return;
+        }
+      e->sector = sector;
+      entries[entry_cnt++] = e;
+    }
+  memcpy (e->data, buffer, BLOCK_SECTOR_SIZE);
+  lock_release (&journal_lock);
+}
+
+/* Drops any pending writes to the CNT sectors starting at SECTOR,
+   which are being freed and may be reused for file data that is
+   not journaled. */
+void
+journal_revoke (block_sector_t sector, size_t cnt)
+{
+  size_t i;
+
+  lock_acquire (&journal_lock);
+  for (i = 0; i < entry_cnt; )
+    if (entries[i]->sector >= sector && entries[i]->sector < sector + cnt)
+      {
+        free (entries[i]);
+        entries[i] = entries[--entry_cnt];
+      }
+    else
+      i++;
+  lock_release (&journal_lock);
+}
+
+/* Commits the pending writes as one group and writes them to
+   their home locations.  More than JOURNAL_ENTRIES writes, which
+   only an operation that overran the journal leaves behind, are
+   committed as several groups.  The caller must hold
+   journal_lock. */
+static void
+flush (void)
+{
+  struct journal_header *h;
+  size_t first, cnt, i, j;
+
+  ASSERT (lock_held_by_current_thread (&journal_lock));
+  flush_wanted = false;
+  if (entry_cnt == 0)
+    {
+      group_no++;
+      return;
+    }
+
+  /* Sort by home location, so that the home writes sweep across
+     the disk in one direction. */
+  for (i = 1; i < entry_cnt; i++)
+    {
+      struct journal_entry *e = entries[i];
+      for (j = i; j > 0 && entries[j - 1]->sector > e->sector; j--)
+        entries[j] = entries[j - 1];
+      entries[j] = e;
+    }
+
+  h = calloc (1, sizeof *h);
+  if (h == NULL)
+    PANIC ("can't allocate journal header");
+  h->magic = JOURNAL_MAGIC;
+
+  for (first = 0; first < entry_cnt; first += cnt)
+    {
+      struct journal_entry **group = entries + first;
+
+      cnt = entry_cnt - first;
+      if (cnt > JOURNAL_ENTRIES)
+        cnt = JOURNAL_ENTRIES;
+
+      /* Log, then commit. */
+      for (i = 0; i < cnt; i++)
+        {
+          block_write (fs_device, JOURNAL_SECTOR + 1 + i, group[i]->data);
+          h->sectors[i] = group[i]->sector;
+        }
+      h->cnt = cnt;
+      block_write (fs_device, JOURNAL_SECTOR, h);
+
+      /* Write home, then retire the group. */
+      for (i = 0; i < cnt; i++)
+        {
+          block_write (fs_device, group[i]->sector, group[i]->data);
+          free (group[i]);
+        }
+      h->cnt = 0;
+      block_write (fs_device, JOURNAL_SECTOR, h);
+
+      commit_cnt++;
+      logged_cnt += cnt;
+    }
+  free (h);
+  entry_cnt = 0;
+  group_no++;
+}
+
+/* Prints journal statistics. */
+void
+journal_print_stats (void)
+{
+  printf ("Journal: %lld commits, %lld sectors logged, "
+          "%lld writes absorbed\n",
+          commit_cnt, logged_cnt, absorbed_cnt);
+}
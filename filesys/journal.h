@@ -0,0 +1,30 @@
+#ifndef FILESYS_JOURNAL_H
+#define FILESYS_JOURNAL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "devices/block.h"
+
+/* The journal occupies JOURNAL_SECTORS sectors starting at
+   JOURNAL_SECTOR: a header sector followed by one sector for each
+   metadata sector that a commit can log. */
+#define JOURNAL_ENTRIES 126
+#define JOURNAL_SECTORS (JOURNAL_ENTRIES + 1)
+
+void journal_init (bool format);
+void journal_done (void);
+
+void journal_begin (void);
+void journal_commit (void);
+void journal_checkpoint (void);
+void journal_flush (void);
+void journal_request_flush (void);
+unsigned journal_group (void);
+
+void journal_read (block_sector_t, void *);
+void journal_write (block_sector_t, const void *);
+void journal_revoke (block_sector_t, size_t cnt);
+
+void journal_print_stats (void);
+
+#endif /* filesys/journal.h */
@@ -0,0 +1,249 @@
+#include "filesys/reaper.h"
+#include <debug.h>
+#include <list.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "filesys/filesys.h"
+#include "filesys/inode.h"
+#include "filesys/journal.h"
+#include "threads/malloc.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#ifdef USERPROG
+#include "userprog/syscall.h"
+#endif
+
+/* Deferred reclamation of removed files.
+
+   Freeing the blocks of a large file takes a walk over all of its
+   indirect blocks, so instead of doing it in inode_close(), in
+   the context of whichever process happens to close the file
+   last, the inode is handed to a kernel thread, the reaper, and
+   inode_close() returns at once.
+
+   So that a crash cannot leak the space of a file that was
+   removed but not yet reclaimed, inode_remove() records the inode
+   in the orphan list in ORPHAN_SECTOR, in the same journal
+   transaction that erases its directory entry.  The reaper takes
+   it off the list in the transaction that frees it, and
+   reaper_init() queues whatever is still on the list at boot. */
+
+/* Identifies the orphan list. */
+#define ORPHAN_MAGIC 0x4f525048
+
+/* Maximum number of orphans recorded on disk.  Files removed
+   while the list is full are still reclaimed, but a crash before
+   then leaks their space. */
+#define ORPHAN_MAX 126
+
+/* On-disk orphan list.
+   Must be exactly BLOCK_SECTOR_SIZE bytes long. */
+struct orphan_list
+  {
+    unsigned magic;                     /* Magic number. */
+    uint32_t cnt;                       /* Number of orphans. */
+    block_sector_t inumbers[ORPHAN_MAX]; /* Removed inodes. */
+  };
+
+/* A closed, removed inode waiting for the reaper. */
+struct reap_entry
+  {
+    struct list_elem elem;              /* Element in queue. */
+    block_sector_t inumber;             /* Inode to reclaim. */
+  };
+
+static struct orphan_list orphans;      /* Copy of ORPHAN_SECTOR. */
+static struct list queue;               /* Inodes to reclaim. */
+static struct lock queue_lock;          /* Protects the above. */
+static struct semaphore queued;         /* Upped once per queued inode. */
+static struct lock reap_lock;           /* Held while reclaiming. */
+
+static thread_func reaper;
+static void reap_queued (void);
+static void reap (block_sector_t inumber);
+
+/* Initializes the reaper and starts its thread.  If FORMAT is
+   true, the orphan list is emptied; otherwise, every orphan left
+   on it by the last run is queued for reclamation. */
+void
+reaper_init (bool format)
+{
+  size_t i;
+
+  ASSERT (sizeof orphans == BLOCK_SECTOR_SIZE);
+  list_init (&queue);
+  lock_init (&queue_lock);
+  sema_init (&queued, 0);
+  lock_init (&reap_lock);
+
+  journal_read (ORPHAN_SECTOR, &orphans);
+  if (format || orphans.magic != ORPHAN_MAGIC || orphans.cnt > ORPHAN_MAX)
+    {
+      memset (&orphans, 0, sizeof orphans);
+      orphans.magic = ORPHAN_MAGIC;
+      journal_write (ORPHAN_SECTOR, &orphans);
+    }
+  else if (orphans.cnt > 0)
+    printf ("Reclaiming %u orphaned inodes...\n", (unsigned) orphans.cnt);
+  for (i = 0; i < orphans.cnt; i++)
+    reaper_queue (orphans.inumbers[i]);
+
+  if (thread_create ("reaper", PRI_DEFAULT, reaper, NULL) == TID_ERROR)
+    PANIC ("can't start reaper thread");
+}
+
+/* Stops the reaper and reclaims the inodes still queued. */
+void
+reaper_done (void)
+{
+  lock_acquire (&reap_lock);
+  reap_queued ();
+}
+
+/* Reclaims the inodes still queued at once, instead of leaving
+   them to the reaper thread, so that their space can be reused
+   as soon as this returns.  With user programs, the caller must
+   hold the file system lock, without which the reaper cannot
+   reclaim anything; taking reap_lock here instead would deadlock
+   against a reaper waiting for that lock. */
+void
+reaper_flush (void)
+{
+#ifdef USERPROG
+  ASSERT (lock_held_by_current_thread (&read_write_lock));
+  reap_queued ();
+#else
+  lock_acquire (&reap_lock);
+  reap_queued ();
+  lock_release (&reap_lock);
+#endif
+}
+
+/* Records removed inode INUMBER in the on-disk orphan list.  Must
+   be called within a journal transaction. */
+void
+reaper_orphan (block_sector_t inumber)
+{
+  lock_acquire (&queue_lock);
+  if (orphans.cnt < ORPHAN_MAX)
+    {
+      orphans.inumbers[orphans.cnt++] = inumber;
+      journal_write (ORPHAN_SECTOR, &orphans);
+    }
+  lock_release (&queue_lock);
+}
+
+/* Queues removed inode INUMBER, which is no longer open, to have
+   its blocks and inode freed by the reaper.  If memory is short,
+   reclaims it at once instead. */
+void
+reaper_queue (block_sector_t inumber)
+{
+  struct reap_entry *r = malloc (sizeof *r);
+
+  if (r == NULL)
+    {
+      reap (inumber);
+      return;
+    }
+  r->inumber = inumber;
+  lock_acquire (&queue_lock);
+  list_push_back (&queue, &r->elem);
+  lock_release (&queue_lock);
+  sema_up (&queued);
+}
+
+/* Returns true if inode INUMBER has been removed but not yet
+   reclaimed, so that its blocks may be freed at any time.  Once
+   this returns false for an inode, it stays false as long as the
+   caller holds the inode open. */
+bool
+reaper_pending (block_sector_t inumber)
+{
+  struct list_elem *e;
+  bool pending = false;
+  size_t i;
+
+  lock_acquire (&queue_lock);
+  for (i = 0; i < orphans.cnt && !pending; i++)
+    pending = orphans.inumbers[i] == inumber;
+  for (e = list_begin (&queue); e != list_end (&queue) && !pending;
+       e = list_next (e))
+    pending = list_entry (e, struct reap_entry, elem)->inumber == inumber;
+  lock_release (&queue_lock);
+  return pending;
+}
+
+/* Reaper thread. */
+static void
+reaper (void *aux UNUSED)
+{
+  for (;;)
+    {
+      struct reap_entry *r;
+
+      sema_down (&queued);
+      lock_acquire (&reap_lock);
+#ifdef USERPROG
+      /* Dequeue under the file system lock, so that an inode is
+         never off the queue while reaper_pending() can still be
+         asked about it. */
+      lock_acquire (&read_write_lock);
+#endif
+      lock_acquire (&queue_lock);
+      r = list_empty (&queue) ? NULL : list_entry (list_pop_front (&queue),
+                                                   struct reap_entry, elem);
+      lock_release (&queue_lock);
+      if (r != NULL)
+        {
+          reap (r->inumber);
+          free (r);
+        }
+#ifdef USERPROG
+      lock_release (&read_write_lock);
+#endif
+      lock_release (&reap_lock);
+    }
+}
+
+/* Reclaims every inode on the queue.  The caller must keep the
+   reaper thread from reclaiming at the same time. */
+static void
+reap_queued (void)
+{
+  for (;;)
+    {
+      struct reap_entry *r;
+
+      lock_acquire (&queue_lock);
+      r = list_empty (&queue) ? NULL : list_entry (list_pop_front (&queue),
+                                                   struct reap_entry, elem);
+      lock_release (&queue_lock);
+      if (r == NULL)
+        break;
+      reap (r->inumber);
+      free (r);
+    }
+}
+
+/* Frees removed inode INUMBER and takes it off the orphan list,
+   in a single journal transaction. */
+static void
+reap (block_sector_t inumber)
+{
+  size_t i;
+
+  journal_begin ();
+  inode_reclaim (inumber);
+  lock_acquire (&queue_lock);
+  for (i = 0; i < orphans.cnt; i++)
+    if (orphans.inumbers[i] == inumber)
+      {
+        orphans.inumbers[i] = orphans.inumbers[--orphans.cnt];
+        journal_write (ORPHAN_SECTOR, &orphans);
+        break;
+      }
+  lock_release (&queue_lock);
+  journal_commit ();
+}
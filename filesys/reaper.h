@@ -0,0 +1,15 @@
+#ifndef FILESYS_REAPER_H
+#define FILESYS_REAPER_H
+
+#include <stdbool.h>
+#include "devices/block.h"
+
+void reaper_init (bool format);
+void reaper_done (void);
+void reaper_flush (void);
+
+void reaper_orphan (block_sector_t inumber);
+void reaper_queue (block_sector_t inumber);
+bool reaper_pending (block_sector_t inumber);
+
+#endif /* filesys/reaper.h */
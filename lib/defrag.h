@@ -0,0 +1,21 @@
+#ifndef __LIB_DEFRAG_H
+#define __LIB_DEFRAG_H
+
+#include <stdbool.h>
+
+/* Flags for defrag(), see lib/user/syscall.h. */
+#define DEFRAG_START 1          /* Start a pass, unless one is running. */
+#define DEFRAG_WAIT 2           /* Wait for the running pass to end. */
+
+/* The defragmenter's progress, as returned by defrag(). */
+struct defrag_stats
+  {
+    bool running;               /* Is a pass in progress? */
+    unsigned passes;            /* Passes completed. */
+    unsigned files_moved;       /* Files relocated. */
+    unsigned sectors_moved;     /* Data sectors relocated. */
+    unsigned free_runs;         /* Runs of free sectors on disk. */
+    unsigned free_largest;      /* Longest run of free sectors. */
+  };
+
+#endif /* lib/defrag.h */
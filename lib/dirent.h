@@ -0,0 +1,18 @@
+#ifndef __LIB_DIRENT_H
+#define __LIB_DIRENT_H
+
+#include <stdbool.h>
+
+/* Longest file name in a directory entry. */
+#define DIRENT_NAME_MAX 14
+
+/* One directory entry returned by getdents(), see
+   lib/user/syscall.h. */
+struct dirent
+  {
+    int d_ino;                          /* Inode number. */
+    bool d_isdir;                       /* Is it a directory? */
+    char d_name[DIRENT_NAME_MAX + 1];   /* Null-terminated name. */
+  };
+
+#endif /* lib/dirent.h */
@@ -0,0 +1,65 @@
+#ifndef __LIB_IO_RING_H
+#define __LIB_IO_RING_H
+
+/* Shared-memory rings for submitting batches of file operations
+   with a single system call.
+
+   A process places a struct io_ring in its own memory, within a
+   single page, and registers it with io_ring_setup().  To submit
+   operations it fills in entries of sq[] starting at index
+   sq_tail % IO_RING_ENTRIES, advances sq_tail past them and calls
+   io_ring_enter().  The kernel takes the entries between sq_head
+   and sq_tail, advances sq_head, and runs them in order on a
+   kernel thread while the process continues.  Each operation's
+   result is posted at cq[cq_tail % IO_RING_ENTRIES] and cq_tail
+   advanced; the process reads results from cq_head onward,
+   advancing cq_head past the ones it has consumed.
+
+   The kernel never overruns the completion ring: io_ring_enter()
+   only takes as many entries as there are free completion slots,
+   and returns that number. */
+
+/* Number of entries in each ring. */
+#define IO_RING_ENTRIES 32
+
+/* Operations. */
+enum io_ring_op
+  {
+    IO_RING_NOP,                /* Do nothing, result 0. */
+    IO_RING_OPEN,               /* open (buf), result is a fd or -1. */
+    IO_RING_READ,               /* read (fd, buf, len). */
+    IO_RING_WRITE,              /* write (fd, buf, len). */
+    IO_RING_SEEK,               /* seek (fd, len), result 0 or -1. */
+    IO_RING_CLOSE               /* close (fd), result 0 or -1. */
+  };
+
+/* Submission queue entry. */
+struct io_sqe
+  {
+    int op;                     /* One of enum io_ring_op. */
+    int fd;                     /* File descriptor. */
+    void *buf;                  /* Buffer, or file name for open. */
+    unsigned len;               /* Buffer size, or position for seek. */
+    unsigned user_data;         /* Copied to the completion. */
+  };
+
+/* Completion queue entry. */
+struct io_cqe
+  {
+    unsigned user_data;         /* From the submission. */
+    int result;                 /* What the system call would return. */
+  };
+
+/* A pair of rings.  Head and tail indexes only ever increase;
+   an index's slot is the index modulo IO_RING_ENTRIES. */
+struct io_ring
+  {
+    volatile unsigned sq_head;  /* Next entry the kernel takes. */
+    volatile unsigned sq_tail;  /* Next entry the process fills in. */
+    volatile unsigned cq_head;  /* Next completion the process reads. */
+    volatile unsigned cq_tail;  /* Next completion the kernel posts. */
+    struct io_sqe sq[IO_RING_ENTRIES];
+    struct io_cqe cq[IO_RING_ENTRIES];
+  };
+
+#endif /* lib/io-ring.h */
@@ -0,0 +1,17 @@
+#ifndef __LIB_STAT_H
+#define __LIB_STAT_H
+
+#include <stdbool.h>
+
+/* A file's metadata, as returned by stat() and fstat(), see
+   lib/user/syscall.h. */
+struct stat
+  {
+    int st_ino;                 /* Inode number. */
+    int st_size;                /* Size in bytes. */
+    bool st_isdir;              /* Is it a directory? */
+    unsigned st_blocks;         /* Sectors allocated to data. */
+    int st_parent;              /* Inode number of parent directory. */
+  };
+
+#endif /* lib/stat.h */
@@ -28,7 +28,25 @@ enum
     SYS_MKDIR,                  /* Create a directory. */
     SYS_READDIR,                /* Reads a directory entry. */
     SYS_ISDIR,                  /* Tests if a fd represents a directory. */
-    SYS_INUMBER                 /* Returns the inode number for a fd. */
+    SYS_INUMBER,                /* Returns the inode number for a fd. */
+
+    /* Extensions. */
+    SYS_PREAD,                  /* Read from a file at a given offset. */
+    SYS_PWRITE,                 /* Write to a file at a given offset. */
+    SYS_READV,                  /* Read from a file into several buffers. */
+    SYS_WRITEV,                 /* Write several buffers to a file. */
+    SYS_IO_RING_SETUP,          /* Register submission/completion rings. */
+    SYS_IO_RING_ENTER,          /* Submit operations from the rings. */
+    SYS_COPY_FILE_RANGE,        /* Copy data from one file to another. */
+    SYS_FSYNC,                  /* Write a file's data to disk. */
+    SYS_SYNC,                   /* Write all data to disk. */
+    SYS_GETDENTS,               /* Read many directory entries. */
+    SYS_STAT,                   /* Get a file's metadata by name. */
+    SYS_FSTAT,                  /* Get an open file's metadata. */
+    SYS_RENAME,                 /* Move a file to a new name. */
+    SYS_FTRUNCATE,              /* Set an open file's length. */
+    SYS_FALLOCATE,              /* Reserve space for an open file. */
+    SYS_DEFRAG                  /* Run or monitor the defragmenter. */
   };
 
 #endif /* lib/syscall-nr.h */
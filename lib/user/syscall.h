@@ -3,6 +3,11 @@
 
 #include <stdbool.h>
 #include <debug.h>
+#include <defrag.h>
+#include <dirent.h>
+#include <io-ring.h>
+#include <iovec.h>
+#include <stat.h>
 
 /* Process identifier. */
 typedef int pid_t;
@@ -45,4 +50,22 @@ bool readdir (int fd, char name[READDIR_MAX_LEN + 1]);
 bool isdir (int fd);
 int inumber (int fd);
 
+/* Extensions. */
+int pread (int fd, void *buffer, unsigned length, unsigned offset);
+int pwrite (int fd, const void *buffer, unsigned length, unsigned offset);
+int readv (int fd, const struct iovec *iov, int iovcnt);
+int writev (int fd, const struct iovec *iov, int iovcnt);
+int io_ring_setup (struct io_ring *);
+int io_ring_enter (unsigned min_complete);
+int copy_file_range (int fd_in, int fd_out, unsigned length);
+int fsync (int fd);
+void sync (void);
+int getdents (int fd, struct dirent *, unsigned size);
+int stat (const char *file, struct stat *);
+int fstat (int fd, struct stat *);
+bool rename (const char *old, const char *new);
+int ftruncate (int fd, unsigned length);
+int fallocate (int fd, unsigned offset, unsigned length);
+int defrag (int flags, struct defrag_stats *);
+
 #endif /* lib/user/syscall.h */
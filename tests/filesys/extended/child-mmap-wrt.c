@@ -0,0 +1,26 @@
+/* Child process for mmap-exit-persist.
+   Writes to a file created by our parent through a memory
+   mapping, then exits without unmapping it or closing the
+   file. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/filesys/extended/mmap-persist.h"
+#include "tests/lib.h"
+
+const char *test_name = "child-mmap-wrt";
+
+#define ACTUAL ((void *) 0x10000000)
+
+int
+main (void) 
+{
+  int fd;
+
+  quiet = true;
+
+  CHECK ((fd = open ("mapped")) > 1, "open \"mapped\"");
+  CHECK (mmap (fd, ACTUAL) != MAP_FAILED, "mmap \"mapped\"");
+  memcpy ((char *) ACTUAL + MAPPED_OFS, mapped_text, sizeof mapped_text - 1);
+  return 0;
+}
@@ -0,0 +1,61 @@
+/* Fragments two files by growing them a sector at a time in
+   turn, syncing each sector so that it is placed on disk before
+   the next, then runs a defragmentation pass and checks that it
+   moved them without changing their contents. */
+
+#include <random.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define SECTOR_SIZE 512
+#define SECTOR_CNT 64
+#define FILE_SIZE (SECTOR_CNT * SECTOR_SIZE)
+static char buf_a[FILE_SIZE];
+static char buf_b[FILE_SIZE];
+
+/* Writes sector IDX of BUF to FILE_NAME, open as FD, and syncs
+   it to disk. */
+static void
+write_sector (const char *file_name, int fd, const char *buf, size_t idx) 
+{
+  if (write (fd, buf + idx * SECTOR_SIZE, SECTOR_SIZE) != SECTOR_SIZE)
+    fail ("write sector %zu of \"%s\" failed", idx, file_name);
+  if (fsync (fd) != 0)
+    fail ("fsync \"%s\" failed", file_name);
+}
+
+void
+test_main (void) 
+{
+  struct defrag_stats st;
+  int fd_a, fd_b;
+  size_t i;
+
+  random_init (0);
+  random_bytes (buf_a, sizeof buf_a);
+  random_bytes (buf_b, sizeof buf_b);
+
+  CHECK (create ("a", 0), "create \"a\"");
+  CHECK (create ("b", 0), "create \"b\"");
+  CHECK ((fd_a = open ("a")) > 1, "open \"a\"");
+  CHECK ((fd_b = open ("b")) > 1, "open \"b\"");
+
+  msg ("write \"a\" and \"b\" a sector at a time, alternately");
+  for (i = 0; i < SECTOR_CNT; i++)
+    {
+      write_sector ("a", fd_a, buf_a, i);
+      write_sector ("b", fd_b, buf_b, i);
+    }
+  msg ("close \"a\"");
+  close (fd_a);
+  msg ("close \"b\"");
+  close (fd_b);
+
+  CHECK (defrag (DEFRAG_START | DEFRAG_WAIT, &st) == 0, "defrag");
+  CHECK (!st.running && st.passes > 0, "verify pass finished");
+  CHECK (st.files_moved > 0, "verify files were moved");
+
+  check_file ("a", buf_a, FILE_SIZE);
+  check_file ("b", buf_b, FILE_SIZE);
+}
@@ -0,0 +1,25 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(defrag-file) begin
+(defrag-file) create "a"
+(defrag-file) create "b"
+(defrag-file) open "a"
+(defrag-file) open "b"
+(defrag-file) write "a" and "b" a sector at a time, alternately
+(defrag-file) close "a"
+(defrag-file) close "b"
+(defrag-file) defrag
+(defrag-file) verify pass finished
+(defrag-file) verify files were moved
+(defrag-file) open "a" for verification
+(defrag-file) verified contents of "a"
+(defrag-file) close "a"
+(defrag-file) open "b" for verification
+(defrag-file) verified contents of "b"
+(defrag-file) close "b"
+(defrag-file) end
+EOF
+pass;
@@ -0,0 +1,51 @@
+/* Lists a directory holding a file and a subdirectory with
+   getdents(), checking each entry's type and inode number, and
+   checks that a buffer too small for one entry is rejected. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+/* Returns the entry named NAME among the CNT in ENTS, failing the
+   test if there is none. */
+static struct dirent *
+find_entry (struct dirent *ents, int cnt, const char *name) 
+{
+  int i;
+
+  for (i = 0; i < cnt; i++)
+    if (!strcmp (ents[i].d_name, name))
+      return &ents[i];
+  fail ("\"%s\" not listed", name);
+}
+
+void
+test_main (void) 
+{
+  struct dirent ents[4];
+  struct dirent *e;
+  int fd, sub_fd;
+
+  CHECK (mkdir ("a"), "mkdir \"a\"");
+  CHECK (create ("a/file", 0), "create \"a/file\"");
+  CHECK (mkdir ("a/sub"), "mkdir \"a/sub\"");
+  CHECK ((fd = open ("a")) > 1, "open \"a\"");
+  CHECK (getdents (fd, ents, sizeof *ents - 1) == -1,
+         "getdents \"a\" with short buffer (must return -1)");
+  CHECK (getdents (fd, ents, sizeof ents) == 2, "getdents \"a\"");
+
+  e = find_entry (ents, 2, "file");
+  CHECK (!e->d_isdir, "verify \"file\" is not a directory");
+  e = find_entry (ents, 2, "sub");
+  CHECK (e->d_isdir, "verify \"sub\" is a directory");
+  CHECK ((sub_fd = open ("a/sub")) > 1, "open \"a/sub\"");
+  CHECK (e->d_ino == inumber (sub_fd), "verify inode number of \"sub\"");
+  msg ("close \"a/sub\"");
+  close (sub_fd);
+
+  CHECK (getdents (fd, ents, sizeof ents) == 0,
+         "getdents \"a\" at end (must return 0)");
+  msg ("close \"a\"");
+  close (fd);
+}
@@ -0,0 +1,22 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(dir-getdents) begin
+(dir-getdents) mkdir "a"
+(dir-getdents) create "a/file"
+(dir-getdents) mkdir "a/sub"
+(dir-getdents) open "a"
+(dir-getdents) getdents "a" with short buffer (must return -1)
+(dir-getdents) getdents "a"
+(dir-getdents) verify "file" is not a directory
+(dir-getdents) verify "sub" is a directory
+(dir-getdents) open "a/sub"
+(dir-getdents) verify inode number of "sub"
+(dir-getdents) close "a/sub"
+(dir-getdents) getdents "a" at end (must return 0)
+(dir-getdents) close "a"
+(dir-getdents) end
+EOF
+pass;
@@ -0,0 +1,7 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_archive ({"a" => {},
+		"b" => {"moved" => ["This file moves without being copied.\n"]}});
+pass;
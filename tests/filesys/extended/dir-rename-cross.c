@@ -0,0 +1,27 @@
+/* Moves a file into another directory with rename(), then makes
+   sure that it is found only under its new name, with its
+   contents intact. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+static const char text[] = "This file moves without being copied.\n";
+
+void
+test_main (void) 
+{
+  int fd;
+
+  CHECK (mkdir ("a"), "mkdir \"a\"");
+  CHECK (mkdir ("b"), "mkdir \"b\"");
+  CHECK (create ("a/file", 0), "create \"a/file\"");
+  CHECK ((fd = open ("a/file")) > 1, "open \"a/file\"");
+  CHECK (write (fd, text, sizeof text - 1) == sizeof text - 1,
+         "write \"a/file\"");
+  msg ("close \"a/file\"");
+  close (fd);
+  CHECK (rename ("a/file", "b/moved"), "rename \"a/file\" to \"b/moved\"");
+  CHECK (open ("a/file") == -1, "open \"a/file\" (must return -1)");
+  check_file ("b/moved", text, sizeof text - 1);
+}
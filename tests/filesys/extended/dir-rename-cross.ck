@@ -0,0 +1,20 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(dir-rename-cross) begin
+(dir-rename-cross) mkdir "a"
+(dir-rename-cross) mkdir "b"
+(dir-rename-cross) create "a/file"
+(dir-rename-cross) open "a/file"
+(dir-rename-cross) write "a/file"
+(dir-rename-cross) close "a/file"
+(dir-rename-cross) rename "a/file" to "b/moved"
+(dir-rename-cross) open "a/file" (must return -1)
+(dir-rename-cross) open "b/moved" for verification
+(dir-rename-cross) verified contents of "b/moved"
+(dir-rename-cross) close "b/moved"
+(dir-rename-cross) end
+EOF
+pass;
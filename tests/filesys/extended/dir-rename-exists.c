@@ -0,0 +1,18 @@
+/* Tries to rename a file onto the name of another file, which
+   must fail and leave both files as they were. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+static char zeros[200];
+
+void
+test_main (void) 
+{
+  CHECK (create ("a", 100), "create \"a\"");
+  CHECK (create ("b", 200), "create \"b\"");
+  CHECK (!rename ("a", "b"), "rename \"a\" to \"b\" (must return false)");
+  check_file ("a", zeros, 100);
+  check_file ("b", zeros, 200);
+}
@@ -0,0 +1,18 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(dir-rename-exists) begin
+(dir-rename-exists) create "a"
+(dir-rename-exists) create "b"
+(dir-rename-exists) rename "a" to "b" (must return false)
+(dir-rename-exists) open "a" for verification
+(dir-rename-exists) verified contents of "a"
+(dir-rename-exists) close "a"
+(dir-rename-exists) open "b" for verification
+(dir-rename-exists) verified contents of "b"
+(dir-rename-exists) close "b"
+(dir-rename-exists) end
+EOF
+pass;
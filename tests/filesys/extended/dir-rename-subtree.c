@@ -0,0 +1,20 @@
+/* Tries to move a directory into itself and into one of its own
+   subdirectories, both of which must fail and leave the tree as
+   it was. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  CHECK (mkdir ("a"), "mkdir \"a\"");
+  CHECK (mkdir ("a/b"), "mkdir \"a/b\"");
+  CHECK (!rename ("a", "a/c"), "rename \"a\" to \"a/c\" (must return false)");
+  CHECK (!rename ("a", "a/b/c"),
+         "rename \"a\" to \"a/b/c\" (must return false)");
+  CHECK (chdir ("a/b"), "chdir \"a/b\"");
+  CHECK (chdir ("/"), "chdir \"/\"");
+  CHECK (!chdir ("a/b/c"), "chdir \"a/b/c\" (must return false)");
+}
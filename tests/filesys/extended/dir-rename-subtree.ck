@@ -0,0 +1,16 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(dir-rename-subtree) begin
+(dir-rename-subtree) mkdir "a"
+(dir-rename-subtree) mkdir "a/b"
+(dir-rename-subtree) rename "a" to "a/c" (must return false)
+(dir-rename-subtree) rename "a" to "a/b/c" (must return false)
+(dir-rename-subtree) chdir "a/b"
+(dir-rename-subtree) chdir "/"
+(dir-rename-subtree) chdir "a/b/c" (must return false)
+(dir-rename-subtree) end
+EOF
+pass;
@@ -0,0 +1,6 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_archive ({"a" => {"file" => ["xyz" . ("\0" x 197) . "xyz"]}});
+pass;
@@ -0,0 +1,41 @@
+/* Checks the size, type, inode number and parent directory that
+   stat() and fstat() report for a file and a directory. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  struct stat st, dir_st;
+  int fd, dir_fd;
+
+  CHECK (mkdir ("a"), "mkdir \"a\"");
+  CHECK (create ("a/file", 100), "create \"a/file\"");
+  CHECK (stat ("a/file", &st) == 0, "stat \"a/file\"");
+  CHECK (st.st_size == 100, "verify size of \"a/file\"");
+  CHECK (!st.st_isdir, "verify \"a/file\" is not a directory");
+  CHECK ((fd = open ("a/file")) > 1, "open \"a/file\"");
+  CHECK (st.st_ino == inumber (fd), "verify inode number of \"a/file\"");
+
+  CHECK (stat ("a", &dir_st) == 0, "stat \"a\"");
+  CHECK (dir_st.st_isdir, "verify \"a\" is a directory");
+  CHECK (st.st_parent == dir_st.st_ino, "verify parent of \"a/file\"");
+  CHECK ((dir_fd = open ("a")) > 1, "open \"a\"");
+  CHECK (dir_st.st_ino == inumber (dir_fd), "verify inode number of \"a\"");
+  msg ("close \"a\"");
+  close (dir_fd);
+
+  CHECK (write (fd, "xyz", 3) == 3, "write \"a/file\"");
+  seek (fd, 200);
+  CHECK (write (fd, "xyz", 3) == 3, "write \"a/file\" at offset 200");
+  CHECK (fstat (fd, &st) == 0, "fstat \"a/file\"");
+  CHECK (st.st_size == 203, "verify size of \"a/file\" after growth");
+  msg ("close \"a/file\"");
+  close (fd);
+
+  CHECK (stat ("a/missing", &st) == -1,
+         "stat \"a/missing\" (must return -1)");
+  CHECK (fstat (fd, &st) == -1, "fstat closed fd (must return -1)");
+}
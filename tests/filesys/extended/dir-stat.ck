@@ -0,0 +1,29 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(dir-stat) begin
+(dir-stat) mkdir "a"
+(dir-stat) create "a/file"
+(dir-stat) stat "a/file"
+(dir-stat) verify size of "a/file"
+(dir-stat) verify "a/file" is not a directory
+(dir-stat) open "a/file"
+(dir-stat) verify inode number of "a/file"
+(dir-stat) stat "a"
+(dir-stat) verify "a" is a directory
+(dir-stat) verify parent of "a/file"
+(dir-stat) open "a"
+(dir-stat) verify inode number of "a"
+(dir-stat) close "a"
+(dir-stat) write "a/file"
+(dir-stat) write "a/file" at offset 200
+(dir-stat) fstat "a/file"
+(dir-stat) verify size of "a/file" after growth
+(dir-stat) close "a/file"
+(dir-stat) stat "a/missing" (must return -1)
+(dir-stat) fstat closed fd (must return -1)
+(dir-stat) end
+EOF
+pass;
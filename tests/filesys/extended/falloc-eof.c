@@ -0,0 +1,35 @@
+/* Reserves space past the end of a file with fallocate(), which
+   must not change its size, then writes into the reserved space
+   well past the old end of file: the gap must read as zeros. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+static char buf[5001];
+
+void
+test_main (void) 
+{
+  struct stat st;
+  size_t i;
+  int fd;
+
+  for (i = 0; i < 100; i++)
+    buf[i] = i % 251;
+  buf[sizeof buf - 1] = 'x';
+
+  CHECK (create ("testfile", 0), "create \"testfile\"");
+  CHECK ((fd = open ("testfile")) > 1, "open \"testfile\"");
+  CHECK (write (fd, buf, 100) == 100, "write \"testfile\"");
+  CHECK (fallocate (fd, 0, 10000) == 0, "fallocate \"testfile\"");
+  CHECK (filesize (fd) == 100, "filesize \"testfile\" is still 100");
+  CHECK (fstat (fd, &st) == 0, "fstat \"testfile\"");
+  CHECK (st.st_blocks >= 20, "10000 bytes are allocated");
+  msg ("seek \"testfile\"");
+  seek (fd, sizeof buf - 1);
+  CHECK (write (fd, buf + sizeof buf - 1, 1) == 1, "write \"testfile\"");
+  msg ("close \"testfile\"");
+  close (fd);
+  check_file ("testfile", buf, sizeof buf);
+}
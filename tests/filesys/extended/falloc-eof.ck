@@ -0,0 +1,22 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(falloc-eof) begin
+(falloc-eof) create "testfile"
+(falloc-eof) open "testfile"
+(falloc-eof) write "testfile"
+(falloc-eof) fallocate "testfile"
+(falloc-eof) filesize "testfile" is still 100
+(falloc-eof) fstat "testfile"
+(falloc-eof) 10000 bytes are allocated
+(falloc-eof) seek "testfile"
+(falloc-eof) write "testfile"
+(falloc-eof) close "testfile"
+(falloc-eof) open "testfile" for verification
+(falloc-eof) verified contents of "testfile"
+(falloc-eof) close "testfile"
+(falloc-eof) end
+EOF
+pass;
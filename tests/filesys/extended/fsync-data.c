@@ -0,0 +1,30 @@
+/* Writes a file in two parts, calling fsync() after each, and
+   verifies its contents.  The persistence check then finds the
+   data on disk. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+static char buf[3000];
+
+void
+test_main (void) 
+{
+  size_t i;
+  int fd;
+
+  for (i = 0; i < sizeof buf; i++)
+    buf[i] = i % 251;
+
+  CHECK (create ("testfile", 0), "create \"testfile\"");
+  CHECK ((fd = open ("testfile")) > 1, "open \"testfile\"");
+  CHECK (write (fd, buf, 1000) == 1000, "write \"testfile\"");
+  CHECK (fsync (fd) == 0, "fsync \"testfile\"");
+  CHECK (write (fd, buf + 1000, sizeof buf - 1000) == sizeof buf - 1000,
+         "write \"testfile\"");
+  CHECK (fsync (fd) == 0, "fsync \"testfile\"");
+  msg ("close \"testfile\"");
+  close (fd);
+  check_file ("testfile", buf, sizeof buf);
+}
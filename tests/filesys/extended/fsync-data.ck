@@ -0,0 +1,19 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(fsync-data) begin
+(fsync-data) create "testfile"
+(fsync-data) open "testfile"
+(fsync-data) write "testfile"
+(fsync-data) fsync "testfile"
+(fsync-data) write "testfile"
+(fsync-data) fsync "testfile"
+(fsync-data) close "testfile"
+(fsync-data) open "testfile" for verification
+(fsync-data) verified contents of "testfile"
+(fsync-data) close "testfile"
+(fsync-data) end
+EOF
+pass;
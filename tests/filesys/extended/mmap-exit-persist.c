@@ -0,0 +1,25 @@
+/* Runs child-mmap-wrt, which writes to a file through a memory
+   mapping and exits without unmapping it.  The changes must be
+   written back by the time the child's exit status is
+   reported. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/filesys/extended/mmap-persist.h"
+#include "tests/lib.h"
+#include "tests/main.h"
+
+static char buf[MAPPED_SIZE];
+
+void
+test_main (void) 
+{
+  pid_t child;
+
+  CHECK (create ("mapped", MAPPED_SIZE), "create \"mapped\"");
+  CHECK ((child = exec ("child-mmap-wrt")) != -1, "exec \"child-mmap-wrt\"");
+  CHECK (wait (child) == 0, "wait for child (should return 0)");
+
+  memcpy (buf + MAPPED_OFS, mapped_text, sizeof mapped_text - 1);
+  check_file ("mapped", buf, sizeof buf);
+}
@@ -0,0 +1,15 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(mmap-exit-persist) begin
+(mmap-exit-persist) create "mapped"
+(mmap-exit-persist) exec "child-mmap-wrt"
+(mmap-exit-persist) wait for child (should return 0)
+(mmap-exit-persist) open "mapped" for verification
+(mmap-exit-persist) verified contents of "mapped"
+(mmap-exit-persist) close "mapped"
+(mmap-exit-persist) end
+EOF
+pass;
@@ -0,0 +1,8 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+my ($text) = "Written through a memory mapping.\n";
+my ($data) = "\0" x 500 . $text . "\0" x (1024 - 500 - length ($text));
+check_archive ({"a" => {"mapped" => [$data]}});
+pass;
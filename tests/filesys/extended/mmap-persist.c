@@ -0,0 +1,33 @@
+/* Writes to a file in a subdirectory through a memory mapping,
+   across a sector boundary, then unmaps it, which must write the
+   changes back to the file system. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/filesys/extended/mmap-persist.h"
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define ACTUAL ((void *) 0x10000000)
+
+static char buf[MAPPED_SIZE];
+
+void
+test_main (void) 
+{
+  mapid_t map;
+  int fd;
+
+  CHECK (mkdir ("a"), "mkdir \"a\"");
+  CHECK (create ("a/mapped", MAPPED_SIZE), "create \"a/mapped\"");
+  CHECK ((fd = open ("a/mapped")) > 1, "open \"a/mapped\"");
+  CHECK ((map = mmap (fd, ACTUAL)) != MAP_FAILED, "mmap \"a/mapped\"");
+  memcpy ((char *) ACTUAL + MAPPED_OFS, mapped_text, sizeof mapped_text - 1);
+  msg ("munmap \"a/mapped\"");
+  munmap (map);
+  msg ("close \"a/mapped\"");
+  close (fd);
+
+  memcpy (buf + MAPPED_OFS, mapped_text, sizeof mapped_text - 1);
+  check_file ("a/mapped", buf, sizeof buf);
+}
@@ -0,0 +1,18 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(mmap-persist) begin
+(mmap-persist) mkdir "a"
+(mmap-persist) create "a/mapped"
+(mmap-persist) open "a/mapped"
+(mmap-persist) mmap "a/mapped"
+(mmap-persist) munmap "a/mapped"
+(mmap-persist) close "a/mapped"
+(mmap-persist) open "a/mapped" for verification
+(mmap-persist) verified contents of "a/mapped"
+(mmap-persist) close "a/mapped"
+(mmap-persist) end
+EOF
+pass;
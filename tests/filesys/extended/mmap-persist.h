@@ -0,0 +1,11 @@
+#ifndef TESTS_FILESYS_EXTENDED_MMAP_PERSIST_H
+#define TESTS_FILESYS_EXTENDED_MMAP_PERSIST_H
+
+/* Size of the mapped file in mmap-persist and mmap-exit-persist,
+   and where in it mapped_text is written. */
+#define MAPPED_SIZE 1024
+#define MAPPED_OFS 500
+
+static const char mapped_text[] = "Written through a memory mapping.\n";
+
+#endif /* tests/filesys/extended/mmap-persist.h */
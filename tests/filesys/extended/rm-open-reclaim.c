@@ -0,0 +1,56 @@
+/* Removes a file that is still open, which must stay usable
+   through its file descriptor, then closes it and checks that its
+   space is reclaimed: each file takes more than half of the disk,
+   so the second can only be written once the first is freed. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define FILE_SIZE (1024 * 1024)
+
+static char buf[4096];
+
+/* Creates NAME and fills it with FILE_SIZE bytes of VALUE,
+   returning its open file descriptor. */
+static int
+fill_file (const char *name, char value) 
+{
+  size_t ofs;
+  int fd;
+
+  CHECK (create (name, 0), "create \"%s\"", name);
+  CHECK ((fd = open (name)) > 1, "open \"%s\"", name);
+  memset (buf, value, sizeof buf);
+  msg ("write %d bytes to \"%s\"", FILE_SIZE, name);
+  for (ofs = 0; ofs < FILE_SIZE; ofs += sizeof buf)
+    if (write (fd, buf, sizeof buf) != (int) sizeof buf)
+      fail ("write %zu bytes at offset %zu in \"%s\" failed",
+            sizeof buf, ofs, name);
+  return fd;
+}
+
+void
+test_main (void) 
+{
+  int fd;
+
+  fd = fill_file ("a", 'a');
+  CHECK (remove ("a"), "remove \"a\"");
+  CHECK (open ("a") == -1, "open \"a\" (must return -1)");
+  seek (fd, FILE_SIZE - sizeof buf);
+  CHECK (read (fd, buf, sizeof buf) == (int) sizeof buf,
+         "read end of removed \"a\"");
+  CHECK (buf[0] == 'a' && buf[sizeof buf - 1] == 'a',
+         "verify end of removed \"a\"");
+  msg ("close \"a\"");
+  close (fd);
+  msg ("sync");
+  sync ();
+
+  fd = fill_file ("b", 'b');
+  msg ("close \"b\"");
+  close (fd);
+  CHECK (remove ("b"), "remove \"b\"");
+}
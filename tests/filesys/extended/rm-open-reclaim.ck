@@ -0,0 +1,23 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(rm-open-reclaim) begin
+(rm-open-reclaim) create "a"
+(rm-open-reclaim) open "a"
+(rm-open-reclaim) write 1048576 bytes to "a"
+(rm-open-reclaim) remove "a"
+(rm-open-reclaim) open "a" (must return -1)
+(rm-open-reclaim) read end of removed "a"
+(rm-open-reclaim) verify end of removed "a"
+(rm-open-reclaim) close "a"
+(rm-open-reclaim) sync
+(rm-open-reclaim) create "b"
+(rm-open-reclaim) open "b"
+(rm-open-reclaim) write 1048576 bytes to "b"
+(rm-open-reclaim) close "b"
+(rm-open-reclaim) remove "b"
+(rm-open-reclaim) end
+EOF
+pass;
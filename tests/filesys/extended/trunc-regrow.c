@@ -0,0 +1,33 @@
+/* Shrinks a file with ftruncate(), then grows it again, which
+   must not bring back the data that was cut off: the bytes past
+   the shorter length, including the rest of the sector it ends
+   in, must read as zeros. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+static char buf[2000];
+
+void
+test_main (void) 
+{
+  size_t i;
+  int fd;
+
+  for (i = 0; i < sizeof buf; i++)
+    buf[i] = i % 251;
+
+  CHECK (create ("testfile", 0), "create \"testfile\"");
+  CHECK ((fd = open ("testfile")) > 1, "open \"testfile\"");
+  CHECK (write (fd, buf, sizeof buf) == sizeof buf, "write \"testfile\"");
+  CHECK (ftruncate (fd, 700) == 0, "ftruncate \"testfile\" to 700 bytes");
+  CHECK (ftruncate (fd, sizeof buf) == 0,
+         "ftruncate \"testfile\" to %zu bytes", sizeof buf);
+  msg ("close \"testfile\"");
+  close (fd);
+
+  memset (buf + 700, 0, sizeof buf - 700);
+  check_file ("testfile", buf, sizeof buf);
+}
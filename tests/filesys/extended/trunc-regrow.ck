@@ -0,0 +1,18 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(trunc-regrow) begin
+(trunc-regrow) create "testfile"
+(trunc-regrow) open "testfile"
+(trunc-regrow) write "testfile"
+(trunc-regrow) ftruncate "testfile" to 700 bytes
+(trunc-regrow) ftruncate "testfile" to 2000 bytes
+(trunc-regrow) close "testfile"
+(trunc-regrow) open "testfile" for verification
+(trunc-regrow) verified contents of "testfile"
+(trunc-regrow) close "testfile"
+(trunc-regrow) end
+EOF
+pass;
@@ -0,0 +1,7 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+my ($data) = join ('', map (chr ($_ % 251), 0...699));
+check_archive ({"testfile" => [$data]});
+pass;
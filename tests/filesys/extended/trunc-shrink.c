@@ -0,0 +1,27 @@
+/* Shrinks a file with ftruncate(), which must cut it to the new
+   length and keep the data before it. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+static char buf[2000];
+
+void
+test_main (void) 
+{
+  size_t i;
+  int fd;
+
+  for (i = 0; i < sizeof buf; i++)
+    buf[i] = i % 251;
+
+  CHECK (create ("testfile", 0), "create \"testfile\"");
+  CHECK ((fd = open ("testfile")) > 1, "open \"testfile\"");
+  CHECK (write (fd, buf, sizeof buf) == sizeof buf, "write \"testfile\"");
+  CHECK (ftruncate (fd, 700) == 0, "ftruncate \"testfile\" to 700 bytes");
+  CHECK (filesize (fd) == 700, "filesize \"testfile\" is 700");
+  msg ("close \"testfile\"");
+  close (fd);
+  check_file ("testfile", buf, 700);
+}
@@ -0,0 +1,29 @@
+/* Copies sample.txt into a new file with copy_file_range(),
+   first 100 bytes and then the rest, which must stop at end of
+   file, and verifies the copy. */
+
+#include <syscall.h>
+#include "tests/userprog/sample.inc"
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  int in, out;
+
+  CHECK (create ("test.txt", 0), "create \"test.txt\"");
+  CHECK ((in = open ("sample.txt")) > 1, "open \"sample.txt\"");
+  CHECK ((out = open ("test.txt")) > 1, "open \"test.txt\"");
+  CHECK (copy_file_range (in, out, 100) == 100,
+         "copy 100 bytes from \"sample.txt\" to \"test.txt\"");
+  CHECK (copy_file_range (in, out, 1000) == sizeof sample - 1 - 100,
+         "copy rest of \"sample.txt\" to \"test.txt\"");
+  CHECK (copy_file_range (in, out, 1000) == 0,
+         "copy at end of \"sample.txt\" (must return 0)");
+  CHECK (copy_file_range (in, in, 1) == -1,
+         "copy \"sample.txt\" to itself (must return -1)");
+  msg ("close \"test.txt\"");
+  close (out);
+  check_file ("test.txt", sample, sizeof sample - 1);
+}
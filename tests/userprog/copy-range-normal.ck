@@ -0,0 +1,21 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(copy-range-normal) begin
+(copy-range-normal) create "test.txt"
+(copy-range-normal) open "sample.txt"
+(copy-range-normal) open "test.txt"
+(copy-range-normal) copy 100 bytes from "sample.txt" to "test.txt"
+(copy-range-normal) copy rest of "sample.txt" to "test.txt"
+(copy-range-normal) copy at end of "sample.txt" (must return 0)
+(copy-range-normal) copy "sample.txt" to itself (must return -1)
+(copy-range-normal) close "test.txt"
+(copy-range-normal) open "test.txt" for verification
+(copy-range-normal) verified contents of "test.txt"
+(copy-range-normal) close "test.txt"
+(copy-range-normal) end
+copy-range-normal: exit(0)
+EOF
+pass;
@@ -0,0 +1,22 @@
+/* Calls fsync() on a file descriptor that has been closed and on
+   ones that were never opened.  Each call must return -1, without
+   killing the process, and sync() must still succeed. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  int fd;
+
+  CHECK ((fd = open ("sample.txt")) > 1, "open \"sample.txt\"");
+  msg ("close \"sample.txt\"");
+  close (fd);
+  CHECK (fsync (fd) == -1, "fsync closed fd returned -1");
+  CHECK (fsync (0x20101234) == -1, "fsync bad fd returned -1");
+  CHECK (fsync (-1) == -1, "fsync negative fd returned -1");
+  msg ("sync");
+  sync ();
+}
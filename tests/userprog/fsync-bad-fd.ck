@@ -0,0 +1,16 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(fsync-bad-fd) begin
+(fsync-bad-fd) open "sample.txt"
+(fsync-bad-fd) close "sample.txt"
+(fsync-bad-fd) fsync closed fd returned -1
+(fsync-bad-fd) fsync bad fd returned -1
+(fsync-bad-fd) fsync negative fd returned -1
+(fsync-bad-fd) sync
+(fsync-bad-fd) end
+fsync-bad-fd: exit(0)
+EOF
+pass;
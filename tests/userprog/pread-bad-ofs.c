@@ -0,0 +1,21 @@
+/* Passes pread() and pwrite() offsets that do not fit in a file
+   offset, which must fail with -1 and leave the file alone. */
+
+#include <syscall.h>
+#include "tests/userprog/sample.inc"
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  char buf[16];
+  int handle;
+
+  CHECK ((handle = open ("sample.txt")) > 1, "open \"sample.txt\"");
+  CHECK (pread (handle, buf, 1, 0x80000000) == -1,
+         "pread at offset 0x80000000 (must return -1)");
+  CHECK (pwrite (handle, buf, sizeof buf, 0x7ffffff8) == -1,
+         "pwrite ending past 0x7fffffff (must return -1)");
+  check_file ("sample.txt", sample, sizeof sample - 1);
+}
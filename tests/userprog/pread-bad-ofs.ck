@@ -0,0 +1,16 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(pread-bad-ofs) begin
+(pread-bad-ofs) open "sample.txt"
+(pread-bad-ofs) pread at offset 0x80000000 (must return -1)
+(pread-bad-ofs) pwrite ending past 0x7fffffff (must return -1)
+(pread-bad-ofs) open "sample.txt" for verification
+(pread-bad-ofs) verified contents of "sample.txt"
+(pread-bad-ofs) close "sample.txt"
+(pread-bad-ofs) end
+pread-bad-ofs: exit(0)
+EOF
+pass;
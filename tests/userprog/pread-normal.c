@@ -0,0 +1,23 @@
+/* Reads parts of sample.txt with pread(), which must not move
+   the file position. */
+
+#include <syscall.h>
+#include "tests/userprog/sample.inc"
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  char buf[100];
+  int handle;
+
+  CHECK ((handle = open ("sample.txt")) > 1, "open \"sample.txt\"");
+  CHECK (pread (handle, buf, 50, 100) == 50, "pread 50 bytes at offset 100");
+  compare_bytes (buf, sample + 100, 50, 100, "sample.txt");
+  CHECK (pread (handle, buf, sizeof buf, 200) == sizeof sample - 1 - 200,
+         "pread past end of file");
+  compare_bytes (buf, sample + 200, sizeof sample - 1 - 200, 200,
+                 "sample.txt");
+  CHECK (tell (handle) == 0, "tell \"sample.txt\" is still 0");
+}
@@ -0,0 +1,14 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(pread-normal) begin
+(pread-normal) open "sample.txt"
+(pread-normal) pread 50 bytes at offset 100
+(pread-normal) pread past end of file
+(pread-normal) tell "sample.txt" is still 0
+(pread-normal) end
+pread-normal: exit(0)
+EOF
+pass;
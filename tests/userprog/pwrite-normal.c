@@ -0,0 +1,26 @@
+/* Writes past the end of a new file with pwrite(), which must
+   extend it without moving the file position, then reads the
+   data back with pread(). */
+
+#include <syscall.h>
+#include "tests/userprog/sample.inc"
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  char buf[sizeof sample - 1];
+  int handle;
+
+  CHECK (create ("test.txt", 0), "create \"test.txt\"");
+  CHECK ((handle = open ("test.txt")) > 1, "open \"test.txt\"");
+  CHECK (pwrite (handle, sample, sizeof buf, 1000) == sizeof buf,
+         "pwrite at offset 1000");
+  CHECK (filesize (handle) == 1000 + sizeof buf,
+         "filesize \"test.txt\" covers the write");
+  CHECK (tell (handle) == 0, "tell \"test.txt\" is still 0");
+  CHECK (pread (handle, buf, sizeof buf, 1000) == sizeof buf,
+         "pread at offset 1000");
+  compare_bytes (buf, sample, sizeof buf, 1000, "test.txt");
+}
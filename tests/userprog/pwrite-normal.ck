@@ -0,0 +1,16 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(pwrite-normal) begin
+(pwrite-normal) create "test.txt"
+(pwrite-normal) open "test.txt"
+(pwrite-normal) pwrite at offset 1000
+(pwrite-normal) filesize "test.txt" covers the write
+(pwrite-normal) tell "test.txt" is still 0
+(pwrite-normal) pread at offset 1000
+(pwrite-normal) end
+pwrite-normal: exit(0)
+EOF
+pass;
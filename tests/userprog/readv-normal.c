@@ -0,0 +1,24 @@
+/* Reads sample.txt into three buffers at once with readv(),
+   which must fill each in turn and stop at end of file. */
+
+#include <syscall.h>
+#include "tests/userprog/sample.inc"
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  char a[10], b[100], c[200];
+  struct iovec iov[3] = {{a, sizeof a}, {b, sizeof b}, {c, sizeof c}};
+  int handle;
+
+  CHECK ((handle = open ("sample.txt")) > 1, "open \"sample.txt\"");
+  CHECK (readv (handle, iov, 3) == sizeof sample - 1,
+         "readv \"sample.txt\" into 3 buffers");
+  compare_bytes (a, sample, sizeof a, 0, "sample.txt");
+  compare_bytes (b, sample + sizeof a, sizeof b, sizeof a, "sample.txt");
+  compare_bytes (c, sample + sizeof a + sizeof b,
+                 sizeof sample - 1 - sizeof a - sizeof b,
+                 sizeof a + sizeof b, "sample.txt");
+}
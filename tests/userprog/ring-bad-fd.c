@@ -0,0 +1,53 @@
+/* Submits reads, a write and a close of file descriptors that
+   are not open through an io_ring.  Each must complete with -1,
+   without killing the process, and the entries around them must
+   still run. */
+
+#include <io-ring.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+static struct io_ring ring __attribute__ ((aligned (4096)));
+static char buf[16];
+
+/* Adds an entry to the submission ring. */
+static void
+submit (int op, int fd) 
+{
+  struct io_sqe *sqe = &ring.sq[ring.sq_tail % IO_RING_ENTRIES];
+  sqe->op = op;
+  sqe->fd = fd;
+  sqe->buf = buf;
+  sqe->len = sizeof buf;
+  sqe->user_data = ring.sq_tail;
+  ring.sq_tail++;
+}
+
+void
+test_main (void) 
+{
+  static const int results[] = {0, -1, -1, -1, -1, 0};
+  unsigned i;
+
+  CHECK (io_ring_setup (&ring) == 0, "io_ring_setup");
+  submit (IO_RING_NOP, 0);
+  submit (IO_RING_READ, 20);
+  submit (IO_RING_READ, 1);
+  submit (IO_RING_WRITE, -5);
+  submit (IO_RING_CLOSE, 0x20101234);
+  submit (IO_RING_NOP, 0);
+  CHECK (io_ring_enter (6) == 6, "io_ring_enter 6 entries");
+
+  for (i = 0; i < 6; i++)
+    {
+      struct io_cqe *cqe = &ring.cq[ring.cq_head % IO_RING_ENTRIES];
+      if (ring.cq_head == ring.cq_tail)
+        fail ("completion %u missing", i);
+      if (cqe->user_data != i || cqe->result != results[i])
+        fail ("completion %u has result %d, expected %u, result %d",
+              cqe->user_data, cqe->result, i, results[i]);
+      ring.cq_head++;
+    }
+  msg ("verified completions");
+}
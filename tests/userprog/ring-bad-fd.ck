@@ -0,0 +1,13 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(ring-bad-fd) begin
+(ring-bad-fd) io_ring_setup
+(ring-bad-fd) io_ring_enter 6 entries
+(ring-bad-fd) verified completions
+(ring-bad-fd) end
+ring-bad-fd: exit(0)
+EOF
+pass;
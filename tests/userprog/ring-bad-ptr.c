@@ -0,0 +1,15 @@
+/* Passes a bad pointer to the io_ring_setup system call,
+   which must cause the process to be terminated with exit code
+   -1. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  msg ("io_ring_setup(0x20101000): %d",
+       io_ring_setup ((struct io_ring *) 0x20101000));
+  fail ("should have called exit(-1)");
+}
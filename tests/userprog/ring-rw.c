@@ -0,0 +1,69 @@
+/* Submits a batch of writes, a seek, a read and a close through
+   an io_ring with one io_ring_enter() call, then checks each
+   completion and the file's contents. */
+
+#include <io-ring.h>
+#include <string.h>
+#include <syscall.h>
+#include "tests/userprog/sample.inc"
+#include "tests/lib.h"
+#include "tests/main.h"
+
+static struct io_ring ring __attribute__ ((aligned (4096)));
+static char buf[sizeof sample];
+
+/* Adds an entry to the submission ring. */
+static void
+submit (int op, int fd, void *buf, unsigned len) 
+{
+  struct io_sqe *sqe = &ring.sq[ring.sq_tail % IO_RING_ENTRIES];
+  sqe->op = op;
+  sqe->fd = fd;
+  sqe->buf = buf;
+  sqe->len = len;
+  sqe->user_data = ring.sq_tail;
+  ring.sq_tail++;
+}
+
+/* Takes the next completion off the ring and checks that it is
+   for entry USER_DATA and has result RESULT. */
+static void
+expect (unsigned user_data, int result) 
+{
+  struct io_cqe *cqe = &ring.cq[ring.cq_head % IO_RING_ENTRIES];
+
+  if (ring.cq_head == ring.cq_tail)
+    fail ("completion %u missing", user_data);
+  if (cqe->user_data != user_data || cqe->result != result)
+    fail ("completion %u has result %d, expected completion %u, result %d",
+          cqe->user_data, cqe->result, user_data, result);
+  ring.cq_head++;
+}
+
+void
+test_main (void) 
+{
+  size_t half = (sizeof sample - 1) / 2;
+  int fd;
+
+  CHECK (create ("test.txt", 0), "create \"test.txt\"");
+  CHECK ((fd = open ("test.txt")) > 1, "open \"test.txt\"");
+  CHECK (io_ring_setup (&ring) == 0, "io_ring_setup");
+
+  submit (IO_RING_WRITE, fd, sample, half);
+  submit (IO_RING_WRITE, fd, sample + half, sizeof sample - 1 - half);
+  submit (IO_RING_SEEK, fd, NULL, 0);
+  submit (IO_RING_READ, fd, buf, sizeof buf);
+  submit (IO_RING_CLOSE, fd, NULL, 0);
+  CHECK (io_ring_enter (5) == 5, "io_ring_enter 5 entries");
+
+  expect (0, half);
+  expect (1, sizeof sample - 1 - half);
+  expect (2, 0);
+  expect (3, sizeof sample - 1);
+  expect (4, 0);
+  msg ("verified completions");
+  compare_bytes (buf, sample, sizeof sample - 1, 0, "test.txt");
+
+  check_file ("test.txt", sample, sizeof sample - 1);
+}
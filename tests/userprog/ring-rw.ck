@@ -0,0 +1,18 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(ring-rw) begin
+(ring-rw) create "test.txt"
+(ring-rw) open "test.txt"
+(ring-rw) io_ring_setup
+(ring-rw) io_ring_enter 5 entries
+(ring-rw) verified completions
+(ring-rw) open "test.txt" for verification
+(ring-rw) verified contents of "test.txt"
+(ring-rw) close "test.txt"
+(ring-rw) end
+ring-rw: exit(0)
+EOF
+pass;
@@ -0,0 +1,23 @@
+/* Writes sample.txt's contents to a new file from three buffers
+   at once with writev(), which must write them in order. */
+
+#include <syscall.h>
+#include "tests/userprog/sample.inc"
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  struct iovec iov[3] = {{sample, 10}, {sample + 10, 100},
+                         {sample + 110, sizeof sample - 1 - 110}};
+  int handle;
+
+  CHECK (create ("test.txt", 0), "create \"test.txt\"");
+  CHECK ((handle = open ("test.txt")) > 1, "open \"test.txt\"");
+  CHECK (writev (handle, iov, 3) == sizeof sample - 1,
+         "writev \"test.txt\" from 3 buffers");
+  msg ("close \"test.txt\"");
+  close (handle);
+  check_file ("test.txt", sample, sizeof sample - 1);
+}
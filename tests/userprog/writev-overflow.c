@@ -0,0 +1,23 @@
+/* Passes readv() and writev() buffers whose lengths add up to
+   more than INT_MAX bytes, which must fail with -1 before any
+   of them is touched. */
+
+#include <limits.h>
+#include <syscall.h>
+#include "tests/userprog/sample.inc"
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  char buf[2];
+  struct iovec iov[2] = {{buf, INT_MAX}, {buf, sizeof buf}};
+  int handle;
+
+  CHECK ((handle = open ("sample.txt")) > 1, "open \"sample.txt\"");
+  CHECK (readv (handle, iov, 2) == -1, "readv past INT_MAX (must return -1)");
+  CHECK (writev (handle, iov, 2) == -1,
+         "writev past INT_MAX (must return -1)");
+  check_file ("sample.txt", sample, sizeof sample - 1);
+}
@@ -0,0 +1,16 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(writev-overflow) begin
+(writev-overflow) open "sample.txt"
+(writev-overflow) readv past INT_MAX (must return -1)
+(writev-overflow) writev past INT_MAX (must return -1)
+(writev-overflow) open "sample.txt" for verification
+(writev-overflow) verified contents of "sample.txt"
+(writev-overflow) close "sample.txt"
+(writev-overflow) end
+writev-overflow: exit(0)
+EOF
+pass;
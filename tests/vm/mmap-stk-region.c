@@ -0,0 +1,27 @@
+/* Verifies that mapping a file into the region that the stack
+   may grow into, but has not yet, is disallowed, while a mapping
+   that ends just below it is allowed. */
+
+#include <stdint.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+/* The stack may grow to 8 MB below the top of user memory. */
+#define STACK_BOTTOM (0xc0000000 - 8 * 1024 * 1024)
+
+void
+test_main (void) 
+{
+  mapid_t map;
+  int handle;
+
+  CHECK ((handle = open ("sample.txt")) > 1, "open \"sample.txt\"");
+  CHECK (mmap (handle, (void *) (STACK_BOTTOM + 4096)) == MAP_FAILED,
+         "try to mmap in the stack's region");
+  CHECK (mmap (handle, (void *) STACK_BOTTOM) == MAP_FAILED,
+         "try to mmap at the bottom of the stack's region");
+  CHECK ((map = mmap (handle, (void *) (STACK_BOTTOM - 4096))) != MAP_FAILED,
+         "mmap just below the stack's region");
+  munmap (map);
+}
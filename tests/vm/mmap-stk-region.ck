@@ -0,0 +1,13 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(mmap-stk-region) begin
+(mmap-stk-region) open "sample.txt"
+(mmap-stk-region) try to mmap in the stack's region
+(mmap-stk-region) try to mmap at the bottom of the stack's region
+(mmap-stk-region) mmap just below the stack's region
+(mmap-stk-region) end
+EOF
+pass;
@@ -0,0 +1,18 @@
+/* Moves the stack pointer to the last page of the largest stack
+   the kernel allows, 8 MB below the top of user memory, and
+   pushes a word there.
+   This must succeed. */
+
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void)
+{
+  asm volatile
+    ("movl %%esp, %%eax;"        /* Save a copy of the stack pointer. */
+     "movl $0xbf801000, %%esp;"  /* Top of the stack's last page. */
+     "pushl $0;"                 /* Grow the stack there. */
+     "movl %%eax, %%esp"         /* Restore copied stack pointer. */
+     : : : "eax");               /* Tell GCC we destroyed eax. */
+}
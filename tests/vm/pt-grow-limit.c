@@ -0,0 +1,16 @@
+/* Moves the stack pointer just past the largest stack the kernel
+   allows, 8 MB below the top of user memory, and pushes a word
+   there.
+   The process must be terminated with -1 exit code. */
+
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void)
+{
+  asm volatile
+    ("movl $0xbf800000, %%esp;"  /* Bottom of the largest stack. */
+     "pushl $0"                  /* Grow the stack below it. */
+     : : : "memory");
+}
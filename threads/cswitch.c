@@ -0,0 +1,143 @@
+#include "threads/cswitch.h"
+#include <debug.h>
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "devices/timer.h"
+#include "threads/flags.h"
+#include "threads/palloc.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "threads/vaddr.h"
+
+/* Context switch microbenchmark, run with the "cswitch" action.
+
+   Two kernel threads hand control back and forth through a pair
+   of semaphores, and after each switch the thread that wakes up
+   reads one byte from each page of a small kernel working set, as
+   real kernel code would touch its stack, data and code.  Each
+   round trip is two thread switches.
+
+   Switching between kernel threads no longer loads CR3, since
+   pagedir_activate() skips the load when the page directory is
+   already active, so the benchmark runs twice: once as is, and
+   once with each thread reloading CR3 when it wakes up, as every
+   switch used to.  The difference is the cost of the load and of
+   refilling the TLB afterward.  With kernel pages marked global
+   (CR4.PGE), the reload keeps the working set's TLB entries, so
+   compare against a run with the -no-pge option to see how much
+   the global pages save when a switch does load CR3, as between
+   processes. */
+
+/* Round trips timed per run. */
+#define ROUNDS 10000
+
+/* Pages of kernel memory read after each switch. */
+#define WORKING_SET 32
+
+/* State shared by the two threads. */
+struct pingpong
+  {
+    struct semaphore ping;      /* Upped to wake the partner. */
+    struct semaphore pong;      /* Upped to wake the main thread. */
+    struct semaphore done;      /* Upped when the partner exits. */
+    uint8_t *pages;             /* WORKING_SET pages to read. */
+    bool reload;                /* Reload CR3 after each switch? */
+    int rounds;                 /* Round trips to make. */
+  };
+
+/* Reloads CR3 with the page directory already in it, which
+   flushes every TLB entry that is not global. */
+static void
+reload_cr3 (void)
+{
+  uint32_t cr3;
+
+  asm volatile ("movl %%cr3, %0" : "=r" (cr3));
+  asm volatile ("movl %0, %%cr3" : : "r" (cr3) : "memory");
+}
+
+/* Runs after each switch: optionally reloads CR3, then reads a
+   byte from each page of the working set. */
+static void
+after_switch (const struct pingpong *pp)
+{
+  size_t i;
+
+  if (pp->reload)
+    reload_cr3 ();
+  for (i = 0; i < WORKING_SET; i++)
+    (void) *(volatile uint8_t *) (pp->pages + i * PGSIZE);
+}
+
+/* The partner thread: answers each ping with a pong. */
+static void
+partner (void *pp_)
+{
+  struct pingpong *pp = pp_;
+  int i;
+
+  for (i = 0; i < pp->rounds; i++)
+    {
+      sema_down (&pp->ping);
+      after_switch (pp);
+      sema_up (&pp->pong);
+    }
+  sema_up (&pp->done);
+}
+
+/* Makes ROUNDS round trips between the current thread and a
+   partner, reloading CR3 after each switch if RELOAD is true, and
+   returns the average number of CPU cycles per switch. */
+static uint64_t
+time_switches (uint8_t *pages, bool reload, int rounds)
+{
+  struct pingpong pp;
+  uint64_t start, cycles;
+  int i;
+
+  sema_init (&pp.ping, 0);
+  sema_init (&pp.pong, 0);
+  sema_init (&pp.done, 0);
+  pp.pages = pages;
+  pp.reload = reload;
+  pp.rounds = rounds;
+  if (thread_create ("cswitch", thread_get_priority (), partner, &pp)
+      == TID_ERROR)
+    PANIC ("can't start cswitch partner thread");
+
+  start = timer_cycles ();
+  for (i = 0; i < rounds; i++)
+    {
+      sema_up (&pp.ping);
+      sema_down (&pp.pong);
+      after_switch (&pp);
+    }
+  cycles = timer_cycles () - start;
+
+  sema_down (&pp.done);
+  return cycles / (2 * (uint64_t) rounds);
+}
+
+/* Runs the context switch benchmark and prints the results. */
+void
+cswitch_bench (char **argv UNUSED)
+{
+  uint8_t *pages = palloc_get_multiple (PAL_ASSERT | PAL_ZERO, WORKING_SET);
+  uint64_t skip_cycles, reload_cycles;
+  uint32_t cr4;
+
+  asm volatile ("movl %%cr4, %0" : "=r" (cr4));
+  printf ("cswitch: %d round trips, %d-page working set, global pages %s\n",
+          ROUNDS, WORKING_SET, cr4 & CR4_PGE ? "on" : "off");
+
+  /* Warm up the caches and the TLB. */
+  time_switches (pages, false, ROUNDS / 10);
+
+  skip_cycles = time_switches (pages, false, ROUNDS);
+  reload_cycles = time_switches (pages, true, ROUNDS);
+  printf ("cswitch: %"PRIu64" cycles per switch without a CR3 load, "
+          "%"PRIu64" with one\n", skip_cycles, reload_cycles);
+
+  palloc_free_multiple (pages, WORKING_SET);
+}
@@ -0,0 +1,6 @@
+#ifndef THREADS_CSWITCH_H
+#define THREADS_CSWITCH_H
+
+void cswitch_bench (char **argv);
+
+#endif /* threads/cswitch.h */
@@ -5,4 +5,12 @@
 #define FLAG_MBS  0x00000002    /* Must be set. */
 #define FLAG_IF   0x00000200    /* Interrupt Flag. */
 
+/* CR4 Register. */
+#define CR4_PSE   0x00000010    /* Page Size Extensions. */
+#define CR4_PGE   0x00000080    /* Page Global Enable. */
+
+/* CPUID function 1, EDX feature flags. */
+#define CPUID_PSE 0x00000008    /* 4 MB pages supported. */
+#define CPUID_PGE 0x00002000    /* Global pages supported. */
+
 #endif /* threads/flags.h */
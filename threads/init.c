@@ -15,6 +15,8 @@
 #include "devices/timer.h"
 #include "devices/vga.h"
 #include "devices/rtc.h"
+#include "threads/cswitch.h"
+#include "threads/flags.h"
 #include "threads/interrupt.h"
 #include "threads/io.h"
 #include "threads/loader.h"
@@ -31,6 +33,9 @@
 #else
 #include "tests/threads/tests.h"
 #endif
+#ifdef VM
+#include "vm/share.h"
+#endif
 #ifdef FILESYS
 #include "devices/block.h"
 #include "devices/ide.h"
@@ -57,8 +62,15 @@ static const char *swap_bdev_name;
 /* -ul: Maximum number of pages to put into palloc's user pool. */
 static size_t user_page_limit = SIZE_MAX;
 
+/* -no-pge: Don't mark kernel pages global? */
+static bool no_global_pages;
+
+/* -no-pse: Don't map kernel memory with 4 MB pages? */
+static bool no_large_pages;
+
 static void bss_init (void);
 static void paging_init (void);
+static bool cpu_has_feature (uint32_t edx_flag);
 
 static char **read_command_line (void);
 static char **parse_options (char **argv);
@@ -114,6 +126,9 @@ main (void)
   exception_init ();
   syscall_init ();
 #endif
+#ifdef VM
+  share_init ();
+#endif
 
   /* Start thread scheduler and enable interrupts. */
   thread_start ();
@@ -158,9 +173,21 @@ static void
 paging_init (void)
 {
   uint32_t *pd, *pt;
+  uint32_t cr4;
   size_t page;
   extern char _start, _end_kernel_text;
 
+  /* Every page directory shares the kernel's mappings, so mark
+     them global to keep them in the TLB across the CR3 loads
+     done on context switches.  See [IA32-v3a] 3.11 "Translation
+     Lookaside Buffers (TLBs)". */
+  bool global = !no_global_pages && cpu_has_feature (CPUID_PGE);
+
+  /* Map physical memory with 4 MB pages where we can, so that
+     the kernel's accesses to it need far fewer TLB entries.  See
+     [IA32-v3a] 3.6.1 "Paging Options". */
+  bool large = !no_large_pages && cpu_has_feature (CPUID_PSE);
+
   pd = init_page_dir = palloc_get_page (PAL_ASSERT | PAL_ZERO);
   pt = NULL;
   for (page = 0; page < init_ram_pages; page++)
@@ -171,6 +198,16 @@ paging_init (void)
       size_t pte_idx = pt_no (vaddr);
       bool in_kernel_text = &_start <= vaddr && vaddr < &_end_kernel_text;
 
+      /* A 4 MB page can only cover memory that exists throughout
+         and that holds no kernel text, which must stay read-only. */
+      if (large && pte_idx == 0 && page + (1 << PTBITS) <= init_ram_pages
+          && !(vaddr < &_end_kernel_text && &_start < vaddr + (1 << PDSHIFT)))
+        {
+          pd[pde_idx] = paddr | PTE_PS | PTE_P | PTE_W | (global ? PTE_G : 0);
+          page += (1 << PTBITS) - 1;
+          continue;
+        }
+
       if (pd[pde_idx] == 0)
         {
           pt = palloc_get_page (PAL_ASSERT | PAL_ZERO);
@@ -178,8 +215,19 @@ paging_init (void)
         }
 
       pt[pte_idx] = pte_create_kernel (vaddr, !in_kernel_text);
+      if (global)
+        pt[pte_idx] |= PTE_G;
     }
 
+  /* Large page PDEs are only understood once CR4.PSE is set, and
+     global PTEs have no effect until CR4.PGE is set. */
+  asm volatile ("movl %%cr4, %0" : "=r" (cr4));
+  if (large)
+    cr4 |= CR4_PSE;
+  if (global)
+    cr4 |= CR4_PGE;
+  asm volatile ("movl %0, %%cr4" : : "r" (cr4) : "memory");
+
   /* Store the physical address of the page directory into CR3
      aka PDBR (page directory base register).  This activates our
      new page tables immediately.  See [IA32-v2a] "MOV--Move
@@ -188,6 +236,16 @@ paging_init (void)
   asm volatile ("movl %0, %%cr3" : : "r" (vtop (init_page_dir)));
 }
 
+/* Returns true if CPUID reports the feature EDX_FLAG, one of the
+   CPUID_* flags in threads/flags.h.  See [IA32-v2a] "CPUID". */
+static bool
+cpu_has_feature (uint32_t edx_flag)
+{
+  uint32_t eax, ebx, ecx, edx;
+  asm ("cpuid" : "=a" (eax), "=b" (ebx), "=c" (ecx), "=d" (edx) : "a" (1));
+  return (edx & edx_flag) != 0;
+}
+
 /* Breaks the kernel command line into words and returns them as
    an argv-like array. */
 static char **
@@ -256,6 +314,10 @@ parse_options (char **argv)
         random_init (atoi (value));
       else if (!strcmp (name, "-mlfqs"))
         thread_mlfqs = true;
+      else if (!strcmp (name, "-no-pge"))
+        no_global_pages = true;
+      else if (!strcmp (name, "-no-pse"))
+        no_large_pages = true;
 #ifdef USERPROG
       else if (!strcmp (name, "-ul"))
         user_page_limit = atoi (value);
@@ -309,6 +371,7 @@ run_actions (char **argv)
   static const struct action actions[] = 
     {
       {"run", 2, run_task},
+      {"cswitch", 1, cswitch_bench},
 #ifdef FILESYS
       {"ls", 1, fsutil_ls},
       {"cat", 2, fsutil_cat},
@@ -357,6 +420,7 @@ usage (void)
 #else
           "  run TEST           Run TEST.\n"
 #endif
+          "  cswitch            Time switches between kernel threads.\n"
 #ifdef FILESYS
           "  ls                 List files in the root directory.\n"
           "  cat FILE           Print FILE to the console.\n"
@@ -379,6 +443,8 @@ usage (void)
 #endif
           "  -rs=SEED           Set random number seed to SEED.\n"
           "  -mlfqs             Use multi-level feedback queue scheduler.\n"
+          "  -no-pge            Don't use global pages for kernel memory.\n"
+          "  -no-pse            Don't use 4 MB pages for kernel memory.\n"
 #ifdef USERPROG
           "  -ul=COUNT          Limit user memory to COUNT pages.\n"
 #endif
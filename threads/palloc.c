@@ -7,6 +7,7 @@
 #include <stdint.h>
 #include <stdio.h>
 #include <string.h>
+#include "threads/interrupt.h"
 #include "threads/loader.h"
 #include "threads/synch.h"
 #include "threads/vaddr.h"
@@ -23,13 +24,24 @@
 
    By default, half of system RAM is given to the kernel pool and
    half to the user pool.  That should be huge overkill for the
-   kernel pool, but that's just fine for demonstration purposes. */
+   kernel pool, but that's just fine for demonstration purposes.
+
+   Each pool also remembers which of its free pages are known to
+   contain only zeros.  The idle thread zeroes free pages ahead
+   of time with palloc_zero_free_page(), so that PAL_ZERO
+   requests, such as a new process's stack or page directory,
+   usually get a zeroed page without paying for the memset. */
 
 /* A memory pool. */
 struct pool
   {
     struct lock lock;                   /* Mutual exclusion. */
     struct bitmap *used_map;            /* Bitmap of free pages. */
+    struct bitmap *zeroed_map;          /* Free pages known to be zeroed. */
+    size_t zero_cursor;                 /* Pages from here up are all
+                                           used or zeroed. */
+    unsigned free_cnt;                  /* Number of frees, to detect
+                                           those during a zeroing scan. */
     uint8_t *base;                      /* Base of pool. */
   };
 
@@ -39,6 +51,7 @@ static struct pool kernel_pool, user_pool;
 static void init_pool (struct pool *, void *base, size_t page_cnt,
                        const char *name);
 static bool page_from_pool (const struct pool *, void *page);
+static bool zero_free_page (struct pool *);
 
 /* Initializes the page allocator.  At most USER_PAGE_LIMIT
    pages are put into the user pool. */
@@ -72,13 +85,27 @@ palloc_get_multiple (enum palloc_flags flags, size_t page_cnt)
 {
   struct pool *pool = flags & PAL_USER ? &user_pool : &kernel_pool;
   void *pages;
-  size_t page_idx;
+  size_t page_idx = BITMAP_ERROR;
+  bool zeroed = false;
 
   if (page_cnt == 0)
     return NULL;
 
   lock_acquire (&pool->lock);
-  page_idx = bitmap_scan_and_flip (pool->used_map, 0, page_cnt, false);
+  if ((flags & PAL_ZERO) && page_cnt == 1)
+    {
+      /* Prefer a page that is already zeroed. */
+      page_idx = bitmap_scan (pool->zeroed_map, 0, 1, true);
+      if (page_idx != BITMAP_ERROR)
+        bitmap_mark (pool->used_map, page_idx);
+    }
+  if (page_idx == BITMAP_ERROR)
+    page_idx = bitmap_scan_and_flip (pool->used_map, 0, page_cnt, false);
+  if (page_idx != BITMAP_ERROR)
+    {
+      zeroed = bitmap_all (pool->zeroed_map, page_idx, page_cnt);
+      bitmap_set_multiple (pool->zeroed_map, page_idx, page_cnt, false);
+    }
   lock_release (&pool->lock);
 
   if (page_idx != BITMAP_ERROR)
@@ -88,7 +115,7 @@ palloc_get_multiple (enum palloc_flags flags, size_t page_cnt)
 
   if (pages != NULL) 
     {
-      if (flags & PAL_ZERO)
+      if ((flags & PAL_ZERO) && !zeroed)
         memset (pages, 0, PGSIZE * page_cnt);
     }
   else 
@@ -137,8 +164,13 @@ palloc_free_multiple (void *pages, size_t page_cnt)
   memset (pages, 0xcc, PGSIZE * page_cnt);
 #endif
 
+  /* The pages need zeroing again.  Count the free before the
+     pages become free, so that zero_free_page() notices it. */
+  pool->free_cnt++;
   ASSERT (bitmap_all (pool->used_map, page_idx, page_cnt));
   bitmap_set_multiple (pool->used_map, page_idx, page_cnt, false);
+  if (pool->zero_cursor < page_idx + page_cnt)
+    pool->zero_cursor = page_idx + page_cnt;
 }
 
 /* Frees the page at PAGE. */
@@ -148,15 +180,27 @@ palloc_free_page (void *page)
   palloc_free_multiple (page, 1);
 }
 
+/* Zeroes one free page that is not yet known to be zeroed, so
+   that a later PAL_ZERO allocation can skip the memset.  User
+   pages are zeroed before kernel pages.  Called by the idle
+   thread, so it never sleeps: a pool whose lock is busy is
+   skipped.  Returns false if there was nothing to zero. */
+bool
+palloc_zero_free_page (void)
+{
+  return zero_free_page (&user_pool) || zero_free_page (&kernel_pool);
+}
+
 /* Initializes pool P as starting at START and ending at END,
    naming it NAME for debugging purposes. */
 static void
 init_pool (struct pool *p, void *base, size_t page_cnt, const char *name) 
 {
-  /* We'll put the pool's used_map at its base.
-     Calculate the space needed for the bitmap
+  /* We'll put the pool's used_map and zeroed_map at its base.
+     Calculate the space needed for the bitmaps
      and subtract it from the pool's size. */
-  size_t bm_pages = DIV_ROUND_UP (bitmap_buf_size (page_cnt), PGSIZE);
+  size_t bm_size = bitmap_buf_size (page_cnt);
+  size_t bm_pages = DIV_ROUND_UP (2 * bm_size, PGSIZE);
   if (bm_pages > page_cnt)
     PANIC ("Not enough memory in %s for bitmap.", name);
   page_cnt -= bm_pages;
@@ -165,7 +209,9 @@ init_pool (struct pool *p, void *base, size_t page_cnt, const char *name)
 
   /* Initialize the pool. */
   lock_init (&p->lock);
-  p->used_map = bitmap_create_in_buf (page_cnt, base, bm_pages * PGSIZE);
+  p->used_map = bitmap_create_in_buf (page_cnt, base, bm_size);
+  p->zeroed_map = bitmap_create_in_buf (page_cnt, base + bm_size, bm_size);
+  p->zero_cursor = page_cnt;
   p->base = base + bm_pages * PGSIZE;
 }
 
@@ -180,3 +226,43 @@ page_from_pool (const struct pool *pool, void *page)
 
   return page_no >= start_page && page_no < end_page;
 }
+
+/* Zeroes the highest free page in POOL that is not yet zeroed.
+   First-fit allocation takes pages from the bottom of the pool,
+   so working down from the top keeps zeroed pages out of the
+   way of allocations that do not need them.  The search starts
+   at POOL's zero cursor, below which the last one stopped, so
+   zeroing the whole pool a page at a time scans it only once.
+   Returns false if the pool is busy or has no such page. */
+static bool
+zero_free_page (struct pool *pool)
+{
+  enum intr_level old_level;
+  size_t cursor, page_idx;
+  unsigned free_cnt;
+  bool found = false;
+
+  if (!lock_try_acquire (&pool->lock))
+    return false;
+  cursor = pool->zero_cursor;
+  free_cnt = pool->free_cnt;
+  for (page_idx = cursor; page_idx-- > 0; )
+    if (!bitmap_test (pool->used_map, page_idx)
+        && !bitmap_test (pool->zeroed_map, page_idx))
+      {
+        memset (pool->base + PGSIZE * page_idx, 0, PGSIZE);
+        bitmap_mark (pool->zeroed_map, page_idx);
+        found = true;
+        break;
+      }
+
+  /* palloc_free_multiple() does not take the lock, so a page
+     freed during the scan may lie above where it stopped.  Leave
+     the cursor alone in that case. */
+  old_level = intr_disable ();
+  if (pool->free_cnt == free_cnt)
+    pool->zero_cursor = found ? page_idx : 0;
+  intr_set_level (old_level);
+  lock_release (&pool->lock);
+  return found;
+}
@@ -108,6 +108,10 @@ thread_init (void)
   //Initialize fd table for ?
   list_init(&initial_thread->fd_table);
   initial_thread->fd_table_counter = 2;
+#ifdef VM
+  list_init(&initial_thread->mmap_list);
+  list_init(&initial_thread->shared_list);
+#endif
 
 }
 
@@ -226,6 +230,13 @@ thread_create (const char *name, int priority,
   t->exec_fp = NULL;
   t->load_failed = false;
 
+#ifdef VM
+  /* No files are mapped until the process calls mmap() */
+  list_init(&t->mmap_list);
+  t->mapid_counter = 0;
+  list_init(&t->shared_list);
+#endif
+
   /* Setup current directory to root, NULL signifies root dir as cd */
   t->cd.cd_dir = thread_current()->cd.cd_dir;
 
@@ -431,6 +442,12 @@ idle (void *idle_started_ UNUSED)
 
   for (;;)
     {
+      /* Zero free pages ahead of time while nothing else wants
+         to run, one page at a time so that a thread that becomes
+         ready waits for at most one memset. */
+      while (list_empty (&ready_list) && palloc_zero_free_page ())
+        continue;
+
       /* Let someone else run. */
       intr_disable ();
       thread_block ();
@@ -7,6 +7,8 @@
 #include "threads/synch.h"
 
 
+struct io_ring_ctx;
+
 struct current_directory
 {
   char* cd_str;
@@ -114,8 +116,16 @@ struct thread
    struct child_list_elem *child_data; //Child can update its status for parent to see
 
    struct current_directory cd;
+   struct io_ring_ctx *io_ring; /* Submission/completion rings, see userprog/io-ring.c */
 //#endif
 
+#ifdef VM
+   struct list mmap_list;      /* Files mapped into memory, see vm/mmap.c */
+   int mapid_counter;          /* Next mapid to hand out from mmap() */
+   struct list shared_list;    /* Shared executable pages, see vm/share.c */
+   void *user_esp;             /* User esp on entry to the kernel, see vm/stack.c */
+#endif
+
     /* Owned by thread.c. */
     unsigned magic;                     /* Detects stack overflow. */
   };
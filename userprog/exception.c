@@ -5,13 +5,26 @@
 #include "threads/interrupt.h"
 #include "threads/thread.h"
 #include "threads/vaddr.h"
+#ifdef VM
+#include "devices/timer.h"
+#include "vm/mmap.h"
+#include "vm/stack.h"
+#endif
 
 
 /* Number of page faults processed. */
 static long long page_fault_cnt;
 
+#ifdef VM
+/* Page faults resolved by growing the stack or by reading in a
+   mapped file, and the CPU cycles spent resolving each kind. */
+static long long stack_fault_cnt, mmap_fault_cnt;
+static unsigned long long stack_fault_cycles, mmap_fault_cycles;
+#endif
+
 static void kill (struct intr_frame *);
 static void page_fault (struct intr_frame *);
+static bool in_user_copy (void (*eip) (void));
 
 /* Registers handlers for interrupts that can be caused by user
    programs.
@@ -67,6 +80,14 @@ void
 exception_print_stats (void) 
 {
   printf ("Exception: %lld page faults\n", page_fault_cnt);
+#ifdef VM
+  printf ("Exception: %lld stack growth faults, %llu cycles avg; "
+          "%lld mmap faults, %llu cycles avg\n",
+          stack_fault_cnt,
+          stack_fault_cnt ? stack_fault_cycles / stack_fault_cnt : 0,
+          mmap_fault_cnt,
+          mmap_fault_cnt ? mmap_fault_cycles / mmap_fault_cnt : 0);
+#endif
 }
 
 /* Handler for an exception (probably) caused by a user process. */
@@ -110,6 +131,16 @@ kill (struct intr_frame *f)
     }
 }
 
+/* Returns true if EIP lies in get_user() or put_user(). */
+static bool
+in_user_copy (void (*eip) (void))
+{
+  extern char _start_user_copy, _end_user_copy;
+  char *pc = (char *) eip;
+
+  return &_start_user_copy <= pc && pc < &_end_user_copy;
+}
+
 /* Page fault handler.  This is a skeleton that must be filled in
    to implement virtual memory.  Some solutions to project 2 may
    also require modifying this code.
@@ -150,6 +181,46 @@ page_fault (struct intr_frame *f)
   write = (f->error_code & PF_W) != 0;
   user = (f->error_code & PF_U) != 0;
 
+#ifdef VM
+  /* Bring in a page of a memory mapped file, or grow the stack.
+     Either can also happen in kernel context, when a system call
+     touches a buffer the user passed in; the user's esp is then
+     the one saved on entry to the system call, because F's is the
+     kernel's. */
+  if (not_present && is_user_vaddr (fault_addr))
+    {
+      uint64_t start = timer_cycles ();
+      void *esp = user ? f->esp : thread_current ()->user_esp;
+
+      if (mmap_fault (fault_addr))
+        {
+          mmap_fault_cnt++;
+          mmap_fault_cycles += timer_cycles () - start;
+          return;
+        }
+      if (stack_grow (fault_addr, esp))
+        {
+          stack_fault_cnt++;
+          stack_fault_cycles += timer_cycles () - start;
+          return;
+        }
+    }
+#endif
+
+  /* A fault in get_user() or put_user() in userprog/syscall.c
+     comes from probing a pointer passed in by the user.  They put
+     the address to resume at in eax, and expect -1 there on a
+     fault.  See "Accessing User Memory" in the Pintos reference.
+     The linker places both routines between _start_user_copy and
+     _end_user_copy; any other kernel fault is a kernel bug and
+     must not be resumed at whatever happens to be in eax. */
+  if (!user && is_user_vaddr (fault_addr) && in_user_copy (f->eip))
+    {
+      f->eip = (void (*) (void)) f->eax;
+      f->eax = 0xffffffff;
+      return;
+    }
+
 /*
   /* Check if user are accessing a pointer (due to bad esp) that doesn't exist */
   // kernel does it in syscall.c get_user, for checking for valid pointers
@@ -164,7 +235,8 @@ page_fault (struct intr_frame *f)
   if(not_present)
     exit(-1); */
 
-  exit(-1); // This is a hack, remove this if you are debugging a test! 
+  if (user)
+    exit(-1); // This is a hack, remove this if you are debugging a test! 
 
   /* Check if the user was doing a bad read, e.g. trying to read from null ptr*/
   //if(!write && user)
@@ -0,0 +1,374 @@
+#include "userprog/io-ring.h"
+#include <debug.h>
+#include <stdio.h>
+#include <string.h>
+#include "devices/input.h"
+#include "filesys/directory.h"
+#include "filesys/file.h"
+#include "filesys/filesys.h"
+#include "threads/malloc.h"
+#include "threads/palloc.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "threads/vaddr.h"
+#include "userprog/pagedir.h"
+#include "userprog/process.h"
+#include "userprog/syscall.h"
+
+/* Submission and completion rings, see lib/io-ring.h.
+
+   Each process that calls io_ring_setup() gets a worker kernel
+   thread that runs its submitted operations.  The worker uses
+   the process's file descriptor table and reaches the process's
+   memory through its page directory.  To keep the two from
+   racing, every system call the process makes first waits for
+   the worker to finish its current batch (io_ring_wait_idle()),
+   so the worker only runs while the process is computing in user
+   mode or waiting in io_ring_enter().  Buffers and file names
+   are checked, and brought in if loaded lazily, by
+   io_ring_enter() in the process's context, so the worker never
+   faults. */
+
+/* Kernel side of a process's rings. */
+struct io_ring_ctx
+  {
+    struct thread *owner;               /* Process that owns the rings. */
+    struct io_ring *uring;              /* Rings, user address. */
+    struct io_ring *kring;              /* Rings, kernel address. */
+
+    /* Batch being run by the worker, copied from sq[]. */
+    struct io_sqe sqes[IO_RING_ENTRIES];
+    char *names[IO_RING_ENTRIES];       /* File names for IO_RING_OPEN. */
+    bool bad[IO_RING_ENTRIES];          /* Entry had a bad pointer. */
+    unsigned sqe_cnt;                   /* Number of entries in batch. */
+
+    struct lock lock;                   /* Protects the fields below. */
+    struct condition work;              /* Signaled when busy is set. */
+    struct condition done;              /* Signaled on each completion. */
+    bool busy;                          /* Worker is running a batch. */
+    bool exiting;                       /* Worker should exit. */
+    struct semaphore exited;            /* Upped when the worker exits. */
+  };
+
+static thread_func worker;
+static int run_sqe (struct io_ring_ctx *, unsigned i);
+static int transfer (struct io_ring_ctx *, int fd, uint8_t *ubuf,
+                     unsigned size, bool is_read);
+static struct fd_list_element *lookup_fd (struct thread *, int fd);
+
+/* Registers RING, which must lie within one page of the current
+   process's memory, as the process's rings and starts a worker
+   thread to run the operations submitted to it.  The caller must
+   have checked that RING is writable user memory.  Returns false
+   if RING crosses a page boundary, the process already has rings,
+   or memory is short. */
+bool
+io_ring_setup (struct io_ring *ring)
+{
+  struct thread *t = thread_current ();
+  struct io_ring_ctx *ctx;
+
+  if (t->io_ring != NULL
+      || pg_round_down (ring) != pg_round_down ((uint8_t *) (ring + 1) - 1))
+    return false;
+
+  ctx = calloc (1, sizeof *ctx);
+  if (ctx == NULL)
+    return false;
+  ctx->owner = t;
+  ctx->uring = ring;
+  lock_init (&ctx->lock);
+  cond_init (&ctx->work);
+  cond_init (&ctx->done);
+  sema_init (&ctx->exited, 0);
+  if (thread_create ("io-ring", PRI_DEFAULT, worker, ctx) == TID_ERROR)
+    {
+      free (ctx);
+      return false;
+    }
+
+  ctx->kring = pagedir_get_page (t->pagedir, ring);
+  ctx->kring->sq_head = ctx->kring->sq_tail = 0;
+  ctx->kring->cq_head = ctx->kring->cq_tail = 0;
+  t->io_ring = ctx;
+  return true;
+}
+
+/* Hands the entries the current process has added to its
+   submission ring to the worker, as many as there are free
+   completion slots for, then waits until at least MIN_COMPLETE
+   completions are waiting to be read or the worker runs out of
+   work.  Returns the number of entries taken, or -1 if the
+   process has no rings or has corrupted their indexes. */
+int
+io_ring_enter (unsigned min_complete)
+{
+  struct thread *t = thread_current ();
+  struct io_ring_ctx *ctx = t->io_ring;
+  struct io_ring *ring;
+  unsigned head, cnt, room, i;
+
+  if (ctx == NULL)
+    return -1;
+  io_ring_wait_idle ();
+
+  /* The ring's page may have been unmapped, or paged out, since
+     the last call. */
+  if (!validate_user_buffer (ctx->uring, sizeof *ctx->uring, true))
+    return -1;
+  ring = ctx->kring = pagedir_get_page (t->pagedir, ctx->uring);
+
+  head = ring->sq_head;
+  cnt = ring->sq_tail - head;
+  room = IO_RING_ENTRIES - (ring->cq_tail - ring->cq_head);
+  if (cnt > IO_RING_ENTRIES || room > IO_RING_ENTRIES)
+    return -1;
+  if (cnt > room)
+    cnt = room;
+
+  for (i = 0; i < cnt; i++)
+    {
+      struct io_sqe *sqe = &ctx->sqes[i];
+
+      *sqe = ring->sq[(head + i) % IO_RING_ENTRIES];
+      ctx->names[i] = NULL;
+      ctx->bad[i] = false;
+      if (sqe->op == IO_RING_OPEN)
+        {
+          ctx->names[i] = palloc_get_page (0);
+          ctx->bad[i] = (ctx->names[i] == NULL
+                         || strncpy_from_user (ctx->names[i], sqe->buf,
+                                               PGSIZE) < 0);
+        }
+      else if (sqe->op == IO_RING_READ || sqe->op == IO_RING_WRITE)
+        ctx->bad[i] = !validate_user_buffer (sqe->buf, sqe->len,
+                                             sqe->op == IO_RING_READ);
+    }
+  ring->sq_head = head + cnt;
+  ctx->sqe_cnt = cnt;
+
+  lock_acquire (&ctx->lock);
+  if (cnt > 0)
+    {
+      ctx->busy = true;
+      cond_signal (&ctx->work, &ctx->lock);
+    }
+  while (ctx->busy && ring->cq_tail - ring->cq_head < min_complete)
+    cond_wait (&ctx->done, &ctx->lock);
+  lock_release (&ctx->lock);
+  return cnt;
+}
+
+/* Waits until the current process's worker, if any, has
+   finished its batch.  Called on entry to every system call, see
+   the comment at the top of this file. */
+void
+io_ring_wait_idle (void)
+{
+  struct io_ring_ctx *ctx = thread_current ()->io_ring;
+
+  if (ctx == NULL)
+    return;
+  lock_acquire (&ctx->lock);
+  while (ctx->busy)
+    cond_wait (&ctx->done, &ctx->lock);
+  lock_release (&ctx->lock);
+}
+
+/* Stops the current process's worker and frees its rings.
+   Called when the process exits, before it closes its files. */
+void
+io_ring_destroy (void)
+{
+  struct thread *t = thread_current ();
+  struct io_ring_ctx *ctx = t->io_ring;
+
+  if (ctx == NULL)
+    return;
+  lock_acquire (&ctx->lock);
+  while (ctx->busy)
+    cond_wait (&ctx->done, &ctx->lock);
+  ctx->exiting = true;
+  cond_signal (&ctx->work, &ctx->lock);
+  lock_release (&ctx->lock);
+
+  sema_down (&ctx->exited);
+  t->io_ring = NULL;
+  free (ctx);
+}
+
+/* Worker thread: runs each batch handed over by io_ring_enter(),
+   posting a completion after each entry. */
+static void
+worker (void *ctx_)
+{
+  struct io_ring_ctx *ctx = ctx_;
+
+  lock_acquire (&ctx->lock);
+  for (;;)
+    {
+      unsigned i;
+
+      while (!ctx->busy && !ctx->exiting)
+        cond_wait (&ctx->work, &ctx->lock);
+      if (ctx->exiting)
+        break;
+      lock_release (&ctx->lock);
+
+      /* Relative file names are looked up in the process's
+         current directory. */
+      thread_current ()->cd.cd_dir = ctx->owner->cd.cd_dir;
+
+      for (i = 0; i < ctx->sqe_cnt; i++)
+        {
+          struct io_ring *ring = ctx->kring;
+          struct io_cqe *cqe = &ring->cq[ring->cq_tail % IO_RING_ENTRIES];
+
+          cqe->user_data = ctx->sqes[i].user_data;
+          cqe->result = ctx->bad[i] ? -1 : run_sqe (ctx, i);
+          if (ctx->names[i] != NULL)
+            palloc_free_page (ctx->names[i]);
+
+          lock_acquire (&ctx->lock);
+          barrier ();
+          ring->cq_tail++;
+          if (i + 1 == ctx->sqe_cnt)
+            ctx->busy = false;
+          cond_broadcast (&ctx->done, &ctx->lock);
+          lock_release (&ctx->lock);
+        }
+      lock_acquire (&ctx->lock);
+    }
+  lock_release (&ctx->lock);
+  sema_up (&ctx->exited);
+}
+
+/* Runs entry I of CTX's batch and returns its result. */
+static int
+run_sqe (struct io_ring_ctx *ctx, unsigned i)
+{
+  struct io_sqe *sqe = &ctx->sqes[i];
+  struct fd_list_element *fd_element;
+  int result = -1;
+
+  switch (sqe->op)
+    {
+    case IO_RING_NOP:
+      result = 0;
+      break;
+
+    case IO_RING_OPEN:
+      {
+        bool is_dir = false;
+        struct file *file;
+
+        lock_acquire (&read_write_lock);
+        file = filesys_open (ctx->names[i], false, &is_dir);
+        lock_release (&read_write_lock);
+        if (file != NULL)
+          result = add_file_to_fd_table (ctx->owner, file, is_dir);
+      }
+      break;
+
+    case IO_RING_READ:
+    case IO_RING_WRITE:
+      result = transfer (ctx, sqe->fd, sqe->buf, sqe->len,
+                         sqe->op == IO_RING_READ);
+      break;
+
+    case IO_RING_SEEK:
+      fd_element = lookup_fd (ctx->owner, sqe->fd);
+      if (fd_element != NULL && !fd_element->warning)
+        {
+          lock_acquire (&read_write_lock);
+          file_seek (fd_element->fp, sqe->len);
+          lock_release (&read_write_lock);
+          result = 0;
+        }
+      break;
+
+    case IO_RING_CLOSE:
+      fd_element = lookup_fd (ctx->owner, sqe->fd);
+      if (fd_element != NULL)
+        {
+          list_remove (&fd_element->elem_fd);
+          lock_acquire (&read_write_lock);
+          if (!fd_element->warning)
+            file_close (fd_element->fp);
+          else
+            dir_close ((struct dir *) fd_element->fp);
+          lock_release (&read_write_lock);
+          free (fd_element);
+          result = 0;
+        }
+      break;
+    }
+  return result;
+}
+
+/* Reads or writes SIZE bytes between the file open as FD in
+   CTX's process and the process's buffer UBUF, one page of the
+   buffer at a time through the kernel's mapping of it.  Fd 0 and
+   fd 1 are the console, as for read() and write().  Returns the
+   number of bytes transferred, or -1 if FD is not a file. */
+static int
+transfer (struct io_ring_ctx *ctx, int fd, uint8_t *ubuf, unsigned size,
+          bool is_read)
+{
+  struct fd_list_element *fd_element = NULL;
+  int done = 0;
+
+  if ((fd == 0 && !is_read) || (fd == 1 && is_read))
+    return -1;
+  if (fd != 0 && fd != 1)
+    {
+      fd_element = lookup_fd (ctx->owner, fd);
+      if (fd_element == NULL || fd_element->warning)
+        return -1;
+      lock_acquire (&read_write_lock);
+    }
+
+  while (size > 0)
+    {
+      size_t chunk = PGSIZE - pg_ofs (ubuf);
+      uint8_t *kbuf = pagedir_get_page (ctx->owner->pagedir, ubuf);
+      off_t n;
+
+      ASSERT (kbuf != NULL);
+      if (chunk > size)
+        chunk = size;
+      if (fd == 0)
+        {
+          for (n = 0; n < (off_t) chunk; n++)
+            kbuf[n] = input_getc ();
+        }
+      else if (fd == 1)
+        {
+          putbuf ((char *) kbuf, chunk);
+          n = chunk;
+        }
+      else if (is_read)
+        n = file_read (fd_element->fp, kbuf, chunk);
+      else
+        n = file_write (fd_element->fp, kbuf, chunk);
+
+      done += n;
+      if (n < (off_t) chunk)
+        break;
+      ubuf += chunk;
+      size -= chunk;
+    }
+
+  if (fd_element != NULL)
+    lock_release (&read_write_lock);
+  return done;
+}
+
+/* Returns T's file descriptor table entry for FD, or a null
+   pointer if FD is not open. */
+static struct fd_list_element *
+lookup_fd (struct thread *t, int fd)
+{
+  struct list_elem *e = find_fd_element (fd, t);
+  return e != NULL ? list_entry (e, struct fd_list_element, elem_fd) : NULL;
+}
@@ -0,0 +1,12 @@
+#ifndef USERPROG_IO_RING_H
+#define USERPROG_IO_RING_H
+
+#include <io-ring.h>
+#include <stdbool.h>
+
+bool io_ring_setup (struct io_ring *);
+int io_ring_enter (unsigned min_complete);
+void io_ring_wait_idle (void);
+void io_ring_destroy (void);
+
+#endif /* userprog/io-ring.h */
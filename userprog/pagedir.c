@@ -1,14 +1,20 @@
 #include "userprog/pagedir.h"
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdio.h>
 #include <string.h>
 #include "threads/init.h"
 #include "threads/pte.h"
 #include "threads/palloc.h"
 
 static uint32_t *active_pd (void);
+static void load_pagedir (uint32_t *);
 static void invalidate_pagedir (uint32_t *);
 
+/* Statistics. */
+static long long pd_load_cnt;   /* Page directory loads into CR3. */
+static long long pd_skip_cnt;   /* Loads skipped, already active. */
+
 /* Creates a new page directory that has mappings for kernel
    virtual addresses, but none for user virtual addresses.
    Returns the new page directory, or a null pointer if memory
@@ -214,20 +220,44 @@ pagedir_set_accessed (uint32_t *pd, const void *vpage, bool accessed)
     }
 }
 
-/* Loads page directory PD into the CPU's page directory base
-   register. */
+/* Makes PD the CPU's active page directory, or the kernel-only
+   page directory if PD is null.  Does nothing if PD is already
+   active, since loading CR3 flushes the TLB. */
 void
 pagedir_activate (uint32_t *pd) 
 {
   if (pd == NULL)
     pd = init_page_dir;
 
+  if (active_pd () == pd)
+    {
+      pd_skip_cnt++;
+      return;
+    }
+  load_pagedir (pd);
+}
+
+/* Prints page directory statistics. */
+void
+pagedir_print_stats (void)
+{
+  printf ("Paging: %lld page directory loads, %lld skipped\n",
+          pd_load_cnt, pd_skip_cnt);
+}
+
+/* Loads page directory PD into the CPU's page directory base
+   register, which also flushes every TLB entry that is not
+   global. */
+static void
+load_pagedir (uint32_t *pd)
+{
   /* Store the physical address of the page directory into CR3
      aka PDBR (page directory base register).  This activates our
      new page tables immediately.  See [IA32-v2a] "MOV--Move
      to/from Control Registers" and [IA32-v3a] 3.7.5 "Base
      Address of the Page Directory". */
   asm volatile ("movl %0, %%cr3" : : "r" (vtop (pd)) : "memory");
+  pd_load_cnt++;
 }
 
 /* Returns the currently active page directory. */
@@ -256,8 +286,9 @@ invalidate_pagedir (uint32_t *pd)
 {
   if (active_pd () == pd) 
     {
-      /* Re-activating PD clears the TLB.  See [IA32-v3a] 3.12
-         "Translation Lookaside Buffers (TLBs)". */
-      pagedir_activate (pd);
+      /* Re-loading PD clears the TLB.  See [IA32-v3a] 3.12
+         "Translation Lookaside Buffers (TLBs)".  User pages are
+         never global, so they are all flushed. */
+      load_pagedir (pd);
     } 
 }
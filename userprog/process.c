@@ -6,6 +6,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include "userprog/gdt.h"
+#include "userprog/io-ring.h"
 #include "userprog/pagedir.h"
 #include "userprog/syscall.h"
 #include "userprog/tss.h"
@@ -20,6 +21,10 @@
 #include "threads/vaddr.h"
 #include "threads/synch.h"
 #include "lib/kernel/list.h"
+#ifdef VM
+#include "vm/mmap.h"
+#include "vm/share.h"
+#endif
 
 static thread_func start_process NO_RETURN;
 static bool load (const char *cmdline, void (**eip) (void), void **esp);
@@ -225,7 +230,17 @@ void
 process_exit (int exit_status)
 {
   struct thread *cur = thread_current ();
+    // stop the io_ring worker before it can touch the fd table again
+    io_ring_destroy();
+#ifdef VM
+    // Write back and release every mapped file while the page
+    // directory still holds the dirty bits, before the parent is told we are done
+    mmap_unmap_all();
+    // Drop our references to shared executable pages while exec_fp still keeps the inode alive
+    share_release_all();
+#endif
     // free the fd table element and close its corresponding file
+     lock_acquire(&read_write_lock);
      while(!list_empty(&cur->fd_table))
      {
        struct list_elem *e = list_pop_front (&cur->fd_table);
@@ -242,11 +257,17 @@ process_exit (int exit_status)
        }
        free(element);
      }
+     lock_release(&read_write_lock);
   // Now free the file pointer to the code the user program ran on
   lock_acquire(&open_close_lock);
   if(cur->exec_fp != NULL)
-  file_close(cur->exec_fp);
+  {
+    lock_acquire(&read_write_lock);
+    file_close(cur->exec_fp);
+    lock_release(&read_write_lock);
+  }
   lock_release(&open_close_lock);
+  if(cur->pagedir != NULL) // kernel threads are not processes
   printf ("%s: exit(%d)\n", cur->full_name, exit_status);
 
   // No need to report the exit status if the parent is dead,
@@ -265,7 +286,6 @@ process_exit (int exit_status)
 
 
 
-
   // Go through the child lists and free the data
      while (!list_empty (&cur->child_list))
      {
@@ -307,8 +327,18 @@ process_activate (void)
 {
   struct thread *t = thread_current ();
 
-  /* Activate thread's page tables. */
-  pagedir_activate (t->pagedir);
+  /* Activate thread's page tables.  A kernel thread never
+     touches user memory through user addresses: the io-ring
+     worker, which does reach into its process's buffers, goes
+     through the kernel aliases that pagedir_get_page() returns,
+     and those are mapped in every page directory.  So a kernel
+     thread keeps running on whichever page directory is active,
+     which saves two TLB flushes when it runs between two threads
+     of the same process.  process_exit() activates the
+     kernel-only directory itself before it destroys a process's
+     directory. */
+  if (t->pagedir != NULL)
+    pagedir_activate (t->pagedir);
 
   /* Set thread's kernel stack for use in processing
      interrupts. */
@@ -414,10 +444,11 @@ load (const char *file_name, void (**eip) (void), void **esp)
   process_activate ();
 
 
-  /* Open executable file. */
+  /* Open executable file.  The file system lock is held until
+     the executable is loaded, so that it cannot be moved or
+     reclaimed under us. */
   lock_acquire(&read_write_lock);
   file = filesys_open (argv[0], false, NULL);
-  lock_release(&read_write_lock);
 
   if(file == NULL)
   {
@@ -534,6 +565,8 @@ load (const char *file_name, void (**eip) (void), void **esp)
 
  done:
   /* We arrive here whether the load is successful or not. */
+if(lock_held_by_current_thread(&read_write_lock))
+  lock_release(&read_write_lock);
 
 lock_acquire(&open_close_lock);
  if(!success)
@@ -634,6 +667,22 @@ load_segment (struct file *file, off_t ofs, uint8_t *upage,
       size_t page_read_bytes = read_bytes < PGSIZE ? read_bytes : PGSIZE;
       size_t page_zero_bytes = PGSIZE - page_read_bytes;
 
+#ifdef VM
+      /* Read-only pages are shared with every other process
+         running the same executable, see vm/share.c */
+      if (!writable)
+        {
+          if (!share_map_page (file, ofs, page_read_bytes, upage))
+            return false;
+          read_bytes -= page_read_bytes;
+          zero_bytes -= page_zero_bytes;
+          upage += PGSIZE;
+          ofs += PGSIZE;
+          file_seek (file, ofs);
+          continue;
+        }
+#endif
+
       /* Get a page of memory. */
       uint8_t *kpage = palloc_get_page (PAL_USER);
       if (kpage == NULL)
@@ -658,6 +707,7 @@ load_segment (struct file *file, off_t ofs, uint8_t *upage,
       read_bytes -= page_read_bytes;
       zero_bytes -= page_zero_bytes;
       upage += PGSIZE;
+      ofs += PGSIZE;
     }
   return true;
 }
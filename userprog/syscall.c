@@ -1,15 +1,26 @@
 #include "userprog/syscall.h"
+#include <iovec.h>
+#include <limits.h>
 #include <stdio.h>
+#include <string.h>
 #include <syscall-nr.h>
 #include "threads/interrupt.h"
+#include "threads/palloc.h"
 #include "threads/thread.h"
 #include "threads/vaddr.h"
+#include "devices/input.h"
 #include "devices/shutdown.h"
+#include "userprog/io-ring.h"
 #include "userprog/process.h"
+#include "filesys/file.h"
 #include "filesys/filesys.h"
 #include "threads/synch.h"
 #include "filesys/directory.h"
+#include "filesys/defrag.h"
 #include "filesys/inode.h"
+#ifdef VM
+#include "vm/mmap.h"
+#endif
 
 //#define SYSCALL_DEBUG 1
 
@@ -18,16 +29,40 @@ int add_file_to_fd_table(struct thread* current_thread, struct file* fp, bool wa
 
 static int
 get_user (const uint8_t *uaddr);
+static bool put_user (uint8_t *udst, uint8_t byte);
+static bool copy_from_user (void *dst, const void *usrc, size_t size);
+static bool copy_to_user (void *udst, const void *src, size_t size);
+static uint32_t get_arg (struct intr_frame *f, int n);
+static char *copy_in_string (struct intr_frame *f, const char *ustr);
 static void syscall_handler (struct intr_frame *);
 struct list_elem* find_fd_element(int fd, struct thread* current_thread);
 bool create (const char *file, unsigned initial_size);
+bool remove (const char *file);
 int open (const char *file);
 unsigned tell (int fd);
 bool seek(int fd, unsigned offset);
 bool close (int fd);
 void exit (int status, struct intr_frame *f);
 int write (int fd, const void *buffer, unsigned size, bool * warning);
+int pread (int fd, void *buffer, unsigned size, unsigned offset);
+int pwrite (int fd, const void *buffer, unsigned size, unsigned offset);
+int readv (int fd, const struct iovec *iov, int iovcnt);
+int writev (int fd, const struct iovec *iov, int iovcnt);
+int copy_file_range (int fd_in, int fd_out, unsigned size);
+int fsync (int fd);
+int getdents (int fd, struct dirent *ents, unsigned size);
+int stat (const char *file, struct stat *st);
+int fstat (int fd, struct stat *st);
+bool rename (const char *old, const char *new);
+int ftruncate (int fd, unsigned length);
+int fallocate (int fd, unsigned offset, unsigned length);
+int defrag (int flags, struct defrag_stats *stats);
+#ifdef VM
+mapid_t mmap (int fd, void *addr);
+void munmap (mapid_t mapping);
+#endif
 static struct lock fd_lock;
+static long long syscall_cnt; // Number of system calls made, see syscall_print_stats()
 void
 syscall_init (void)
 {
@@ -49,23 +84,30 @@ syscall_handler (struct intr_frame *f) //UNUSED)
 	if( !is_user_vaddr( f->esp))
 		exit(-1, f);
 
+#ifdef VM
+	// Page faults taken while we touch user memory happen in kernel
+	// context, where the intr_frame esp is the kernel's. Save the
+	// user's esp so the fault handler can still grow the user stack.
+	thread_current()->user_esp = f->esp;
+#endif
+
 	// Check if stack size is over the limit of 8 mb
 	// specifically to pass the test wait-kill
 	// see also : http://courses.cs.vt.edu/cs3204/spring2006/gback/pintos/doc/pintos_5.html#SEC101
 	//printf("%u", (uint32_t) PHYS_BASE - (uint32_t) f->esp);
 	//if(( (uint32_t) PHYS_BASE - (uint32_t) f->esp) > ( (uint32_t ) 3086692358))
 	//	exit(-1, f);
-	//Check for valid esp read access
-	if(get_user((char*) f->esp) == -1)
-		exit(-1, f);
+	// The system call number is at the top of the user stack, with
+	// its arguments above it. Every access to user memory goes
+	// through get_arg(), copy_in_string() or the copy routines at
+	// the bottom of this file, which kill the process on a bad pointer.
+	uint32_t system_call_number = get_arg(f, 0);
+	syscall_cnt++;
 
-	//Assume that the esp pointer goes to the top of the stack (looks at return address)
-	uint32_t system_call_number = * (uint32_t**)(f->esp+0); //Create a pointer to the top of the stack (looks at argv[0])
-	uint32_t* stack_ptr =  (uint32_t*)(f->esp+0); // Two pointers with same address, but using different names
+	// Let the io_ring worker finish with our fd table and memory first,
+	// see userprog/io-ring.c
+	io_ring_wait_idle();
 
-	// Check for valid arg pointers
-  	if (!( is_user_vaddr (stack_ptr + 1) && is_user_vaddr (stack_ptr + 2) && is_user_vaddr (stack_ptr + 3)))
-    	exit (-1,f);
 	// to avoid confusion in usage
 	char* name = NULL;
 	uint32_t file_size = 0;
@@ -86,47 +128,38 @@ syscall_handler (struct intr_frame *f) //UNUSED)
 	switch(system_call_number) { //This gives us the command that needs to be executed
 		case SYS_CREATE: //A pre-defined constant that refers to a "create" call
 		{
-			name = *(stack_ptr+1); //With this, we can load the name of the file
-			if (name == NULL) {
-				exit(-1, f); //If the pointer or file name is empty, then return an error code
-			}
-			file_size = *(stack_ptr+2); //Now get the second arg: the size of the file
+			name = copy_in_string(f, (const char*) get_arg(f, 1)); //With this, we can load the name of the file
+			file_size = get_arg(f, 2); //Now get the second arg: the size of the file
 			f->eax = create(name, file_size); //Create the file and then save the status to the eax register
+			palloc_free_page(name);
 			break;
 		}
 			//(Does this mean that eax is just some storage register. What is it really??)
 		case SYS_OPEN: //A pre-defined constant that refers to an "open" call
 		{
-			name = *(stack_ptr+1); //This looks just to the first and only needed parameter, the file to open
-			if (name == NULL) { //Check for a non-existant file of course
-				exit(-1, f);
-			}
-			else {
-				if(get_user(name) == -1) // check if pointer to name is actually valid
-					exit(-1, f);
-			}
-
+			name = copy_in_string(f, (const char*) get_arg(f, 1)); //This looks just to the first and only needed parameter, the file to open
 
 			fd = open(name); //Going to refer from eax from now on as the "status" register
 			//if(fd == -1)
 			//	exit(-1, f);
+			palloc_free_page(name);
 			f->eax = fd;
 			break;
 		}
 		case SYS_SEEK:
 		{
-			fd = *(stack_ptr + 1);
+			fd = get_arg(f, 1);
 			if(fd <= 0)
 			{
 				exit(-1, f);
 			}
-			file_size = *(stack_ptr + 2);
+			file_size = get_arg(f, 2);
 			f->eax = seek(fd, file_size);
 			break;
 		}
 		case SYS_TELL:
 		{
-			fd = *(stack_ptr + 1);
+			fd = get_arg(f, 1);
 			if(fd <= 0)
 			{
 				exit(-1, f);
@@ -136,11 +169,11 @@ syscall_handler (struct intr_frame *f) //UNUSED)
 		}
 		case SYS_CLOSE:
 		{
-			fd = *(stack_ptr+1); //Just do something almost exactly the same as what was done for SYS_CREATE
+			fd = get_arg(f, 1); //Just do something almost exactly the same as what was done for SYS_CREATE
 			if (fd <= 0) {
 				exit(-1, f); //If the pointer or file name is empty, then return an error code
 			}
-			file_size = *(stack_ptr+2);
+			file_size = get_arg(f, 2);
 			fd = close(fd); //The only line different from SYS_OPEN
 			if(fd == false)
 				exit(-1, f);
@@ -150,17 +183,13 @@ syscall_handler (struct intr_frame *f) //UNUSED)
 		case SYS_READ:
 		{
 
-			fd = *(stack_ptr+1);
-			void* buffer = *(stack_ptr+2);
-			// checks for buffer < PHYS_BASE
-			if( !is_user_vaddr(buffer))
-				exit(-1, f);
-			//Check for valid buffer read access
-			if(get_user(buffer) == -1)
+			fd = get_arg(f, 1);
+			void* buffer = (void*) get_arg(f, 2);
+			file_size = get_arg(f, 3);
+			// Check that every page of the buffer can be written
+			if(!validate_user_buffer(buffer, file_size, true))
 				exit(-1, f);
 
-
-			file_size = *(stack_ptr+3);
 			int size_read = read(fd, buffer, file_size);
 			if(size_read == -1)
 				exit(-1, f);
@@ -171,15 +200,12 @@ syscall_handler (struct intr_frame *f) //UNUSED)
 		}
 		case SYS_WRITE:
 		{
-			fd = *(stack_ptr+1);
-			void* buffer = *(stack_ptr+2);
-			// checks for buffer < PHYS_BASE
-			if( !is_user_vaddr( buffer) )
+			fd = get_arg(f, 1);
+			void* buffer = (void*) get_arg(f, 2);
+			file_size = get_arg(f, 3);
+			// Check that every page of the buffer can be read
+			if(!validate_user_buffer(buffer, file_size, false))
 				exit(-1, f);
-			//Check for valid buffer read access
-			if(get_user(buffer) == -1)
-					exit(-1, f);
-			file_size = *(stack_ptr+3);
 			bool warning = false;
 			int size_write = write(fd, buffer, file_size, &warning);
 			if(size_write == -1 && !warning)
@@ -193,30 +219,23 @@ syscall_handler (struct intr_frame *f) //UNUSED)
 
 		case SYS_FILESIZE:
 		{
-			fd = *(stack_ptr + 1);
+			fd = get_arg(f, 1);
 			f->eax = filesize_get(fd);
 			break;
 		}
 
 		case SYS_REMOVE:
 		{
-			name = *(stack_ptr + 1);
-			if (name == NULL) { //Check for a non-existant file of course
-				exit(-1, f);
-			}
-			else {
-				if(get_user(name) == -1) // check if pointer to name is actually valid
-					exit(-1, f);
-			}
-
-			f->eax = filesys_remove(name);
+			name = copy_in_string(f, (const char*) get_arg(f, 1));
+			f->eax = remove(name);
+			palloc_free_page(name);
 
 			break;
 		}
 
 		case SYS_EXIT:
 	      {
-			fd = *(stack_ptr+1);
+			fd = get_arg(f, 1);
 			f->eax = fd;
 			exit(fd, f);
 			break;
@@ -224,14 +243,15 @@ syscall_handler (struct intr_frame *f) //UNUSED)
 
 	    case SYS_EXEC:
 	    {
-	    	name = *(stack_ptr+1);
+	    	name = copy_in_string(f, (const char*) get_arg(f, 1));
 	    	f->eax = exec(name);
+	    	palloc_free_page(name);
 	    	break;
 	    }
 
 	    case SYS_WAIT:
 	    {
-	    	fd = *(stack_ptr + 1);
+	    	fd = get_arg(f, 1);
 	    	f->eax = wait(fd);
 	    	break;
 	    }
@@ -249,16 +269,11 @@ syscall_handler (struct intr_frame *f) //UNUSED)
 	    if /a/b already exists and /a/b/c does not.*/
 	    case SYS_MKDIR:
 	    {
-	    	name = *(stack_ptr + 1);
-			if (name == NULL) { //Check for a non-existant file of course
-				exit(-1, f);
-			}
-			else {
-				if(get_user(name) == -1) // check if pointer to name is actually valid
-					exit(-1, f);
-			}
-
+	    	name = copy_in_string(f, (const char*) get_arg(f, 1));
+			lock_acquire(&read_write_lock);
 			f->eax = filesys_create(name, 2*sizeof (struct dir_entry), true);
+			lock_release(&read_write_lock);
+			palloc_free_page(name);
 			break;
 
 	    }
@@ -267,16 +282,11 @@ syscall_handler (struct intr_frame *f) //UNUSED)
 	    relative or absolute. Returns true if successful, false on failure.*/
 	    case SYS_CHDIR:
 	    {
-	        name = *(stack_ptr + 1);
-			if (name == NULL) { //Check for a non-existant file of course
-				exit(-1, f);
-			}
-			else {
-				if(get_user(name) == -1) // check if pointer to name is actually valid
-					exit(-1, f);
-			}
-
+	        name = copy_in_string(f, (const char*) get_arg(f, 1));
+			lock_acquire(&read_write_lock);
 			f->eax = filesys_open(name, true, NULL) != NULL ? true : false;
+			lock_release(&read_write_lock);
+			palloc_free_page(name);
 			break;
 
 	    }
@@ -285,7 +295,7 @@ syscall_handler (struct intr_frame *f) //UNUSED)
 	    false if it represents an ordinary file.*/
 		case SYS_ISDIR:
 		{
-			fd = *(stack_ptr + 1);
+			fd = get_arg(f, 1);
 			struct thread* current_thread = thread_current();
 			struct list_elem* e = find_fd_element(fd, current_thread);
 			if(e == NULL) // This should never happen
@@ -308,7 +318,7 @@ syscall_handler (struct intr_frame *f) //UNUSED)
 		the sector number of the inode is suitable for use as an inode number*/
 		case SYS_INUMBER:
 		{
-			fd = *(stack_ptr + 1);
+			fd = get_arg(f, 1);
 			struct thread* current_thread = thread_current();
 			struct list_elem* e = find_fd_element(fd, current_thread);
 			if(e == NULL) // This should never happen
@@ -343,15 +353,9 @@ syscall_handler (struct intr_frame *f) //UNUSED)
 		 */
 		case SYS_READDIR:
 		{
-			fd = *(stack_ptr + 1);
-		    name = *(stack_ptr + 2);
-		    if (name == NULL) { //Check for a non-existant file of course
-				exit(-1, f);
-			}
-			else {
-				if(get_user(name) == -1) // check if pointer to name is actually valid
-					exit(-1, f);
-			}
+			fd = get_arg(f, 1);
+		    name = (char*) get_arg(f, 2);
+		    char entry_name[NAME_MAX + 1];
 			struct thread* current_thread = thread_current();
 			struct list_elem* e = find_fd_element(fd, current_thread);
 			if(e == NULL) // This should never happen
@@ -368,7 +372,11 @@ syscall_handler (struct intr_frame *f) //UNUSED)
 					/* Reads the next directory entry in DIR and stores the name in
 	   				NAME.  Returns true if successful, false if the directory
 	   				contains no more entries. */
-	                f->eax = dir_readdir (dir, name);
+	                lock_acquire(&read_write_lock);
+	                f->eax = dir_readdir (dir, entry_name);
+	                lock_release(&read_write_lock);
+	                if (f->eax && !copy_to_user (name, entry_name, strlen (entry_name) + 1))
+	                	exit(-1, f);
 
 	                /* For Debugging
 	                printf("readdir name %s %p\n", name, dir);
@@ -391,6 +399,192 @@ syscall_handler (struct intr_frame *f) //UNUSED)
 		break;
 		}
 
+#ifdef VM
+		/* Maps the file open as fd into the process's virtual
+		   address space, see mmap() below */
+		case SYS_MMAP:
+		{
+			fd = get_arg(f, 1);
+			void* addr = (void*) get_arg(f, 2);
+			f->eax = mmap(fd, addr);
+			break;
+		}
+
+		case SYS_MUNMAP:
+		{
+			mapid_t mapping = get_arg(f, 1);
+			munmap(mapping);
+			break;
+		}
+#endif
+
+		/* Like read and write, but at the given offset in the file
+		   rather than at the fd's position, see pread() below */
+		case SYS_PREAD:
+		case SYS_PWRITE:
+		{
+			fd = get_arg(f, 1);
+			void* buffer = (void*) get_arg(f, 2);
+			file_size = get_arg(f, 3);
+			unsigned offset = get_arg(f, 4);
+			bool is_read = system_call_number == SYS_PREAD;
+			if(!validate_user_buffer(buffer, file_size, is_read))
+				exit(-1, f);
+			if(is_read)
+				f->eax = pread(fd, buffer, file_size, offset);
+			else
+				f->eax = pwrite(fd, buffer, file_size, offset);
+			break;
+		}
+
+		/* Like read and write, but gathering or scattering the data
+		   through an array of buffers, see readv() below */
+		case SYS_READV:
+		case SYS_WRITEV:
+		{
+			fd = get_arg(f, 1);
+			const struct iovec* uiov = (const struct iovec*) get_arg(f, 2);
+			int iovcnt = get_arg(f, 3);
+			struct iovec iov[IOV_MAX];
+			bool is_read = system_call_number == SYS_READV;
+			size_t total = 0;
+			int i;
+			if(iovcnt < 0 || iovcnt > IOV_MAX)
+			{
+				f->eax = -1;
+				break;
+			}
+			// Copy in the whole array, then check every buffer in it
+			// before touching the file
+			if(!copy_from_user(iov, uiov, iovcnt * sizeof *iov))
+				exit(-1, f);
+			// The byte count is returned as an int, so the buffers may not add up to more than INT_MAX
+			for(i = 0; i < iovcnt && total <= INT_MAX; i++)
+				total = iov[i].iov_len > INT_MAX ? (size_t) INT_MAX + 1 : total + iov[i].iov_len;
+			if(total > INT_MAX)
+			{
+				f->eax = -1;
+				break;
+			}
+			for(i = 0; i < iovcnt; i++)
+				if(!validate_user_buffer(iov[i].iov_base, iov[i].iov_len, is_read))
+					exit(-1, f);
+			if(is_read)
+				f->eax = readv(fd, iov, iovcnt);
+			else
+				f->eax = writev(fd, iov, iovcnt);
+			break;
+		}
+
+		/* Registers a submission/completion ring pair, see lib/io-ring.h */
+		case SYS_IO_RING_SETUP:
+		{
+			struct io_ring* ring = (struct io_ring*) get_arg(f, 1);
+			// A bad pointer kills the process, as for read() and write()
+			if(!validate_user_buffer(ring, sizeof *ring, true))
+				exit(-1, f);
+			f->eax = io_ring_setup(ring) ? 0 : -1;
+			break;
+		}
+
+		/* Submits the ring's new entries, see io_ring_enter() */
+		case SYS_IO_RING_ENTER:
+		{
+			unsigned min_complete = get_arg(f, 1);
+			f->eax = io_ring_enter(min_complete);
+			break;
+		}
+
+		case SYS_COPY_FILE_RANGE:
+		{
+			int fd_in = get_arg(f, 1);
+			int fd_out = get_arg(f, 2);
+			file_size = get_arg(f, 3);
+			f->eax = copy_file_range(fd_in, fd_out, file_size);
+			break;
+		}
+
+		case SYS_FSYNC:
+		{
+			fd = get_arg(f, 1);
+			f->eax = fsync(fd);
+			break;
+		}
+
+		case SYS_GETDENTS:
+		{
+			fd = get_arg(f, 1);
+			struct dirent* ents = (struct dirent*) get_arg(f, 2);
+			file_size = get_arg(f, 3);
+			if(!validate_user_buffer(ents, file_size, true))
+				exit(-1, f);
+			f->eax = getdents(fd, ents, file_size);
+			break;
+		}
+
+		case SYS_STAT:
+		{
+			name = copy_in_string(f, (const char*) get_arg(f, 1));
+			struct stat st;
+			f->eax = stat(name, &st);
+			palloc_free_page(name);
+			if(f->eax == 0 && !copy_to_user((void*) get_arg(f, 2), &st, sizeof st))
+				exit(-1, f);
+			break;
+		}
+
+		case SYS_FSTAT:
+		{
+			fd = get_arg(f, 1);
+			struct stat st;
+			f->eax = fstat(fd, &st);
+			if(f->eax == 0 && !copy_to_user((void*) get_arg(f, 2), &st, sizeof st))
+				exit(-1, f);
+			break;
+		}
+
+		case SYS_RENAME:
+		{
+			name = copy_in_string(f, (const char*) get_arg(f, 1));
+			char* new_name = copy_in_string(f, (const char*) get_arg(f, 2));
+			f->eax = rename(name, new_name);
+			palloc_free_page(name);
+			palloc_free_page(new_name);
+			break;
+		}
+
+		case SYS_FTRUNCATE:
+		{
+			fd = get_arg(f, 1);
+			f->eax = ftruncate(fd, get_arg(f, 2));
+			break;
+		}
+
+		case SYS_FALLOCATE:
+		{
+			fd = get_arg(f, 1);
+			f->eax = fallocate(fd, get_arg(f, 2), get_arg(f, 3));
+			break;
+		}
+
+		case SYS_DEFRAG:
+		{
+			struct defrag_stats* ustats = (struct defrag_stats*) get_arg(f, 2);
+			struct defrag_stats stats;
+			f->eax = defrag(get_arg(f, 1), ustats != NULL ? &stats : NULL);
+			if(ustats != NULL && !copy_to_user(ustats, &stats, sizeof stats))
+				exit(-1, f);
+			break;
+		}
+
+		case SYS_SYNC:
+		{
+			lock_acquire(&read_write_lock);
+			filesys_sync();
+			lock_release(&read_write_lock);
+			break;
+		}
+
 		default:
 		{
 			//#ifdef PROJECT2_DEBUG
@@ -420,7 +614,10 @@ int filesize_get(int fd)
 	struct list_elem* e = find_fd_element(fd, current_thread);
 	if(e == NULL) return -1; // return false if fd not found TODO?
 	struct  fd_list_element *fd_element = list_entry (e, struct fd_list_element, elem_fd);
-	return file_length (fd_element -> fp) ;
+	lock_acquire(&read_write_lock);
+	int length = file_length (fd_element -> fp) ;
+	lock_release(&read_write_lock);
+	return length;
 }
 
 /* Terminates Pintos by calling shutdown_power_off() (declared in "threads/init.h"). This should be seldom used, because you lose some information about possible deadlock situations, etc. */
@@ -473,7 +670,9 @@ int wait (tid_t pid) {
 /* Creates a new file called file initially initial_size bytes in size. Returns true if successful, false otherwise. Creating a new file does not open it: opening the new file is a separate operation which would require a open system call. */
 
 bool create (const char *file, unsigned initial_size) {
+	lock_acquire(&read_write_lock);
 	bool return_bool = filesys_create(file, initial_size, false); //Already in filesys.c...
+	lock_release(&read_write_lock);
 
 	return return_bool;
 }
@@ -484,7 +683,10 @@ bool create (const char *file, unsigned initial_size) {
 
 bool remove (const char *file)
 {
-	return filesys_remove(file);
+	lock_acquire(&read_write_lock);
+	bool success = filesys_remove(file);
+	lock_release(&read_write_lock);
+	return success;
 }
 
 /* Opens the file called file. Returns a nonnegative integer handle called a "file descriptor" (fd), or -1 if the file could not be opened.
@@ -642,6 +844,346 @@ bool close (int fd) {
 
 
 
+/* Reads size bytes from the file open as fd into buffer, starting at byte offset in the file. The fd's position is neither used nor changed, so processes can read any part of a file in one system call rather than a seek followed by a read. Returns the number of bytes actually read (0 at or past end of file), or -1 if fd is not an open file, including the console and directories, or if offset + size does not fit in a file offset. */
+
+int pread (int fd, void *buffer, unsigned size, unsigned offset)
+{
+	struct thread* current_thread = thread_current();
+	struct list_elem* e = find_fd_element(fd, current_thread);
+	if(e == NULL) // console fds 0 and 1 are never in the fd table
+		return -1;
+	struct  fd_list_element *fd_element = list_entry (e, struct fd_list_element, elem_fd);
+	if(fd_element->warning == true) // can't read a directory
+		return -1;
+	if((off_t) offset < 0 || (off_t) size < 0 || (off_t) (offset + size) < 0) // offset and end must fit in an off_t
+		return -1;
+	lock_acquire(&read_write_lock);
+	int return_size = file_read_at (fd_element->fp, buffer, size, offset);
+	lock_release(&read_write_lock);
+	return return_size;
+}
+
+/* Writes size bytes from buffer to the file open as fd, starting at byte offset in the file, extending the file if needed. The fd's position is neither used nor changed. Returns the number of bytes actually written, or -1 if fd is not an open file, including the console and directories, or if offset + size does not fit in a file offset. */
+
+int pwrite (int fd, const void *buffer, unsigned size, unsigned offset)
+{
+	struct thread* current_thread = thread_current();
+	struct list_elem* e = find_fd_element(fd, current_thread);
+	if(e == NULL) // console fds 0 and 1 are never in the fd table
+		return -1;
+	struct  fd_list_element *fd_element = list_entry (e, struct fd_list_element, elem_fd);
+	if(fd_element->warning == true) // can't write a directory
+		return -1;
+	if((off_t) offset < 0 || (off_t) size < 0 || (off_t) (offset + size) < 0) // offset and end must fit in an off_t
+		return -1;
+	lock_acquire(&read_write_lock);
+	int return_size = file_write_at (fd_element->fp, buffer, size, offset);
+	lock_release(&read_write_lock);
+	return return_size;
+}
+
+/* Reads from the file open as fd into the iovcnt buffers described by iov, filling each buffer completely before moving on to the next, as if by one read into a single buffer the size of all of them. Returns the number of bytes actually read, or -1 if fd is not an open file or is a directory, or if the buffers add up to more than INT_MAX bytes. Fd 0 reads from the keyboard. The kernel checks every buffer and takes the file system lock only once for the whole call. */
+
+int readv (int fd, const struct iovec *iov, int iovcnt)
+{
+	int return_size = 0;
+	int i;
+
+	if(fd == 0)
+	{
+		for(i = 0; i < iovcnt; i++)
+		{
+			size_t j;
+			for(j = 0; j < iov[i].iov_len; j++)
+				((char*) iov[i].iov_base)[j] = input_getc();
+			return_size += iov[i].iov_len;
+		}
+		return return_size;
+	}
+
+	struct thread* current_thread = thread_current();
+	struct list_elem* e = find_fd_element(fd, current_thread);
+	if(e == NULL)
+		return -1;
+	struct  fd_list_element *fd_element = list_entry (e, struct fd_list_element, elem_fd);
+	if(fd_element->warning == true) // can't read a directory
+		return -1;
+	lock_acquire(&read_write_lock);
+	for(i = 0; i < iovcnt; i++)
+	{
+		off_t n = file_read (fd_element->fp, iov[i].iov_base, iov[i].iov_len);
+		return_size += n;
+		if((size_t) n < iov[i].iov_len) // end of file
+			break;
+	}
+	lock_release(&read_write_lock);
+	return return_size;
+}
+
+/* Writes the iovcnt buffers described by iov, in order, to the file open as fd, as if by one write from a single buffer holding all of them. Returns the number of bytes actually written, or -1 if fd is not an open file or is a directory, or if the buffers add up to more than INT_MAX bytes. Fd 1 writes to the console with a single putbuf() as long as all the buffers fit in one page, so output from different processes is not interleaved. */
+
+int writev (int fd, const struct iovec *iov, int iovcnt)
+{
+	int return_size = 0;
+	int i;
+
+	if(fd == 1)
+	{
+		size_t total = 0;
+		for(i = 0; i < iovcnt; i++)
+			total += iov[i].iov_len;
+
+		char* kbuf = total <= PGSIZE ? palloc_get_page(0) : NULL;
+		if(kbuf != NULL)
+		{
+			// Gather into one buffer so the output stays together
+			for(i = 0; i < iovcnt; i++)
+			{
+				memcpy(kbuf + return_size, iov[i].iov_base, iov[i].iov_len);
+				return_size += iov[i].iov_len;
+			}
+			putbuf(kbuf, return_size);
+			palloc_free_page(kbuf);
+		}
+		else
+		{
+			for(i = 0; i < iovcnt; i++)
+			{
+				putbuf(iov[i].iov_base, iov[i].iov_len);
+				return_size += iov[i].iov_len;
+			}
+		}
+		return return_size;
+	}
+
+	struct thread* current_thread = thread_current();
+	struct list_elem* e = find_fd_element(fd, current_thread);
+	if(e == NULL)
+		return -1;
+	struct  fd_list_element *fd_element = list_entry (e, struct fd_list_element, elem_fd);
+	if(fd_element->warning == true) // can't write a directory
+		return -1;
+	lock_acquire(&read_write_lock);
+	for(i = 0; i < iovcnt; i++)
+	{
+		off_t n = file_write (fd_element->fp, iov[i].iov_base, iov[i].iov_len);
+		return_size += n;
+		if((size_t) n < iov[i].iov_len) // out of disk space or write denied
+			break;
+	}
+	lock_release(&read_write_lock);
+	return return_size;
+}
+
+/* Copies up to size bytes from the file open as fd_in, starting at its position, to the file open as fd_out at its position, advancing both positions. The data never passes through user memory: it is moved a page at a time through a kernel buffer, with the chunks lined up on fd_in's page, and so sector, boundaries so that the file system reads whole sectors straight into the buffer. Returns the number of bytes copied, which is less than size if fd_in reaches end of file or fd_out's disk fills up, or -1 if either fd is not an open file, is a directory, or both are the same fd. */
+
+int copy_file_range (int fd_in, int fd_out, unsigned size)
+{
+	struct thread* current_thread = thread_current();
+	struct list_elem* e_in = find_fd_element(fd_in, current_thread);
+	struct list_elem* e_out = find_fd_element(fd_out, current_thread);
+	if(e_in == NULL || e_out == NULL || fd_in == fd_out)
+		return -1;
+	struct fd_list_element *in = list_entry (e_in, struct fd_list_element, elem_fd);
+	struct fd_list_element *out = list_entry (e_out, struct fd_list_element, elem_fd);
+	if(in->warning || out->warning) // can't copy to or from a directory
+		return -1;
+
+	uint8_t* buffer = palloc_get_page(0);
+	if(buffer == NULL)
+		return -1;
+
+	int copied = 0;
+	while(size > 0)
+	{
+		lock_acquire(&read_write_lock);
+		off_t pos = file_tell(in->fp);
+		off_t left = file_length(in->fp) - pos;
+		// reads that run past end of file return nothing, so stop exactly there
+		off_t chunk = PGSIZE - pos % PGSIZE;
+		if(chunk > left)
+			chunk = left;
+		if((unsigned) chunk > size)
+			chunk = size;
+		off_t n = chunk > 0 ? file_read(in->fp, buffer, chunk) : 0;
+		off_t written = n > 0 ? file_write(out->fp, buffer, n) : 0;
+		lock_release(&read_write_lock);
+
+		copied += written;
+		size -= written;
+		if(n < chunk || written < n || chunk == 0)
+			break;
+	}
+	palloc_free_page(buffer);
+	return copied;
+}
+
+/* Writes the data of the file open as fd to disk, in sector order, along with all pending file system metadata. When it returns, the file's contents and size survive a crash. Returns 0 if successful, -1 if fd is not open. */
+
+int fsync (int fd)
+{
+	struct list_elem* e = find_fd_element(fd, thread_current());
+	if(e == NULL)
+		return -1;
+	struct fd_list_element *fd_element = list_entry (e, struct fd_list_element, elem_fd);
+	lock_acquire(&read_write_lock);
+	if(fd_element->warning) // directories are opened as struct dir
+		dir_sync((struct dir*) fd_element->fp);
+	else
+		file_sync(fd_element->fp);
+	lock_release(&read_write_lock);
+	return 0;
+}
+
+/* Reads as many entries of the directory open as fd as fit in size bytes at ents, starting where the last readdir or getdents left off, and returns the number read: 0 at the end of the directory, or -1 if fd is not an open directory or size is too small for even one entry, which would otherwise look like the end of the directory. The entries are gathered a page at a time in the kernel, which reads whole directory sectors instead of one entry per trap. */
+
+int getdents (int fd, struct dirent *ents, unsigned size)
+{
+	struct list_elem* e = find_fd_element(fd, thread_current());
+	if(e == NULL)
+		return -1;
+	struct fd_list_element *fd_element = list_entry (e, struct fd_list_element, elem_fd);
+	if(!fd_element->warning) // only directories have entries
+		return -1;
+	if(size < sizeof *ents) // 0 would mean end of directory
+		return -1;
+	struct dirent* page = palloc_get_page(0);
+	if(page == NULL)
+		return -1;
+
+	int cnt = 0;
+	size_t max = size / sizeof *ents;
+	while(max > 0)
+	{
+		size_t n = max < PGSIZE / sizeof *ents ? max : PGSIZE / sizeof *ents;
+		lock_acquire(&read_write_lock);
+		n = dir_getdents((struct dir*) fd_element->fp, page, n);
+		lock_release(&read_write_lock);
+		if(n == 0)
+			break;
+		if(!copy_to_user(ents + cnt, page, n * sizeof *ents))
+			break;
+		cnt += n;
+		max -= n;
+	}
+	palloc_free_page(page);
+	return cnt;
+}
+
+/* Stores the size, type, inode number, allocated sector count and parent directory of file in st, in one trap and one path walk instead of open, filesize, isdir, inumber and close. Returns 0 if successful, -1 if file does not exist. */
+
+int stat (const char *file, struct stat *st)
+{
+	lock_acquire(&read_write_lock);
+	bool success = filesys_stat(file, st);
+	lock_release(&read_write_lock);
+	return success ? 0 : -1;
+}
+
+/* Like stat, but for the file or directory open as fd. Returns 0 if successful, -1 if fd is not open. */
+
+int fstat (int fd, struct stat *st)
+{
+	struct list_elem* e = find_fd_element(fd, thread_current());
+	if(e == NULL)
+		return -1;
+	struct fd_list_element *fd_element = list_entry (e, struct fd_list_element, elem_fd);
+	lock_acquire(&read_write_lock);
+	if(fd_element->warning) // directories are opened as struct dir
+		inode_stat(dir_get_inode((struct dir*) fd_element->fp), st);
+	else
+		inode_stat(file_get_inode(fd_element->fp), st);
+	lock_release(&read_write_lock);
+	return 0;
+}
+
+/* Moves the file or directory old to the name new, which may be in another directory. Only directory entries are rewritten, never the file's data, and the move is atomic: after a crash the file has either its old name or its new one. Returns true if successful, false if old does not exist, new already exists, or a directory would be moved inside itself. */
+
+bool rename (const char *old, const char *new)
+{
+	lock_acquire(&read_write_lock);
+	bool success = filesys_rename(old, new);
+	lock_release(&read_write_lock);
+	return success;
+}
+
+/* Sets the length of the file open as fd to length bytes. Shrinking frees the sectors past the new end of file, and growing leaves a hole that reads as zeros. Returns 0 if successful, -1 if fd is not an open file, is a directory, or writes to it are denied. */
+
+int ftruncate (int fd, unsigned length)
+{
+	struct list_elem* e = find_fd_element(fd, thread_current());
+	if(e == NULL || (off_t) length < 0)
+		return -1;
+	struct fd_list_element *fd_element = list_entry (e, struct fd_list_element, elem_fd);
+	if(fd_element->warning) // can't truncate a directory
+		return -1;
+	lock_acquire(&read_write_lock);
+	bool success = file_truncate(fd_element->fp, length);
+	lock_release(&read_write_lock);
+	return success ? 0 : -1;
+}
+
+/* Reserves disk space for length bytes of the file open as fd, starting at offset, in as few contiguous runs of sectors as possible, so that later writes there don't have to allocate. The file's size doesn't change. Returns 0 if successful, -1 if fd is not an open file, is a directory, or the disk is full. */
+
+int fallocate (int fd, unsigned offset, unsigned length)
+{
+	struct list_elem* e = find_fd_element(fd, thread_current());
+	if(e == NULL || (off_t) offset < 0 || (off_t) length < 0 || (off_t) (offset + length) < 0)
+		return -1;
+	struct fd_list_element *fd_element = list_entry (e, struct fd_list_element, elem_fd);
+	if(fd_element->warning) // can't preallocate a directory
+		return -1;
+	lock_acquire(&read_write_lock);
+	bool success = file_reserve(fd_element->fp, offset, length);
+	lock_release(&read_write_lock);
+	return success ? 0 : -1;
+}
+
+/* Starts a pass of the defragmenter if flags has DEFRAG_START, which moves fragmented files into contiguous runs of sectors in the background, then waits for the pass to end if flags has DEFRAG_WAIT. If stats is not null, stores the defragmenter's progress and the state of free space there. Returns 0. */
+
+int defrag (int flags, struct defrag_stats *stats)
+{
+	if(flags & DEFRAG_START)
+		defrag_start();
+	if(flags & DEFRAG_WAIT)
+		defrag_wait();
+	if(stats != NULL)
+		defrag_get_stats(stats);
+	return 0;
+}
+
+/* Prints system call statistics. */
+void
+syscall_print_stats (void)
+{
+  printf ("Syscall: %lld system calls\n", syscall_cnt);
+}
+
+#ifdef VM
+/* Maps the file open as fd into the process's virtual address space. The entire file is mapped into consecutive virtual pages starting at addr. Pages are read in lazily from the file on first access, see mmap_fault() in vm/mmap.c.
+
+    Fails and returns -1 if the file open as fd has a length of zero, if addr is not page-aligned or is 0, if the range of pages mapped overlaps any existing set of mapped pages, including pages mapped at executable load time, or reaches into the top STACK_MAX bytes of user memory that the stack may grow into, or if fd is 0, 1 or a directory. Otherwise returns a mapping ID that uniquely identifies the mapping within the process. */
+
+mapid_t mmap (int fd, void *addr)
+{
+	struct thread* current_thread = thread_current();
+	struct list_elem* e = find_fd_element(fd, current_thread);
+	if(e == NULL) // console fds 0 and 1 are never in the fd table
+		return MAP_FAILED;
+	struct  fd_list_element *fd_element = list_entry (e, struct fd_list_element, elem_fd);
+	if(fd_element->warning == true) // can't map a directory
+		return MAP_FAILED;
+	return mmap_map(fd_element->fp, addr);
+}
+
+/* Unmaps the mapping designated by mapping, which must be a mapping ID returned by a previous call to mmap by the same process that has not yet been unmapped. Pages that were written to are written back to the file. */
+
+void munmap (mapid_t mapping)
+{
+	mmap_unmap(mapping);
+}
+#endif
+
 // Find the element in the linkedlist coressponding to the given fd
 // Uses: Returns the list_element* type
 // 			You can thus then use this returned type to remove element or
@@ -731,7 +1273,7 @@ struct child_list_elem* add_child_to_list(struct thread* parent_thread, tid_t pi
    UADDR must be below PHYS_BASE.
    Returns the byte value if successful, -1 if a segfault
    occurred. */
-static int
+static int __attribute__ ((noinline, section (".text.user_copy")))
 get_user (const uint8_t *uaddr)
 {
   int result;
@@ -743,7 +1285,7 @@ get_user (const uint8_t *uaddr)
 /* Writes BYTE to user address UDST.
    UDST must be below PHYS_BASE.
    Returns true if successful, false if a segfault occurred. */
-static bool
+static bool __attribute__ ((noinline, section (".text.user_copy")))
 put_user (uint8_t *udst, uint8_t byte)
 {
   int error_code;
@@ -751,3 +1293,136 @@ put_user (uint8_t *udst, uint8_t byte)
        : "=&a" (error_code), "=m" (*udst) : "q" (byte));
   return error_code != -1;
 }
+
+/* Returns the 32-bit word N slots above the user stack pointer
+   in F, that is, the system call number if N is 0 and its Nth
+   argument otherwise.  Kills the process if the word is not in
+   readable user memory. */
+static uint32_t
+get_arg (struct intr_frame *f, int n)
+{
+  uint32_t arg;
+
+  if (!copy_from_user (&arg, (uint32_t *) f->esp + n, sizeof arg))
+    exit (-1, f);
+  return arg;
+}
+
+/* Copies the null-terminated string USTR from user memory into a
+   new page, which the caller must free with palloc_free_page().
+   Strings longer than a page are truncated.  Kills the process if
+   USTR is not in readable user memory. */
+static char *
+copy_in_string (struct intr_frame *f, const char *ustr)
+{
+  char *kstr = palloc_get_page (0);
+
+  if (kstr == NULL)
+    exit (-1, f);
+  if (strncpy_from_user (kstr, ustr, PGSIZE) < 0)
+    {
+      palloc_free_page (kstr);
+      exit (-1, f);
+    }
+  return kstr;
+}
+
+/* Copies SIZE bytes from user address USRC to kernel address
+   DST.  Each page of USRC is probed once with get_user(), which
+   also brings in pages that are loaded lazily, and then copied
+   in bulk.  Returns false if any byte of USRC is not readable
+   user memory. */
+static bool
+copy_from_user (void *dst_, const void *usrc_, size_t size)
+{
+  uint8_t *dst = dst_;
+  const uint8_t *usrc = usrc_;
+
+  while (size > 0)
+    {
+      size_t chunk = PGSIZE - pg_ofs (usrc);
+      if (chunk > size)
+        chunk = size;
+      if (!is_user_vaddr (usrc) || get_user (usrc) == -1)
+        return false;
+      memcpy (dst, usrc, chunk);
+      dst += chunk;
+      usrc += chunk;
+      size -= chunk;
+    }
+  return true;
+}
+
+/* Copies SIZE bytes from kernel address SRC to user address
+   UDST, probing each page of UDST once with put_user().  Returns
+   false if any byte of UDST is not writable user memory. */
+static bool
+copy_to_user (void *udst_, const void *src_, size_t size)
+{
+  uint8_t *udst = udst_;
+  const uint8_t *src = src_;
+
+  while (size > 0)
+    {
+      size_t chunk = PGSIZE - pg_ofs (udst);
+      if (chunk > size)
+        chunk = size;
+      if (!is_user_vaddr (udst) || !put_user (udst, *src))
+        return false;
+      memcpy (udst + 1, src + 1, chunk - 1);
+      udst += chunk;
+      src += chunk;
+      size -= chunk;
+    }
+  return true;
+}
+
+/* Copies the null-terminated string USRC from user memory into
+   the SIZE-byte buffer DST, truncating it if necessary; DST is
+   always null-terminated.  Returns the length of the copied
+   string, or -1 if USRC runs into memory that is not readable
+   user memory before its terminator. */
+int
+strncpy_from_user (char *dst, const char *usrc, size_t size)
+{
+  size_t len = 0;
+
+  ASSERT (size > 0);
+  while (len + 1 < size)
+    {
+      /* Probe once per page, then scan the rest of it. */
+      const char *page_end = (const char *) pg_round_down (usrc) + PGSIZE;
+      if (!is_user_vaddr (usrc) || get_user ((const uint8_t *) usrc) == -1)
+        return -1;
+      for (; usrc < page_end && len + 1 < size; usrc++, len++)
+        if ((dst[len] = *usrc) == '\0')
+          return len;
+    }
+  dst[len] = '\0';
+  return len;
+}
+
+/* Returns true if all SIZE bytes at UBUF are user memory that
+   can be read and, if WRITABLE, written, probing one byte of
+   each page.  Pages that are loaded lazily are brought in, so
+   the kernel can then access UBUF directly without faulting. */
+bool
+validate_user_buffer (const void *ubuf_, size_t size, bool writable)
+{
+  uint8_t *ubuf = (uint8_t *) ubuf_;
+
+  while (size > 0)
+    {
+      size_t chunk = PGSIZE - pg_ofs (ubuf);
+      int byte;
+      if (chunk > size)
+        chunk = size;
+      if (!is_user_vaddr (ubuf) || (byte = get_user (ubuf)) == -1)
+        return false;
+      if (writable && !put_user (ubuf, byte))
+        return false;
+      ubuf += chunk;
+      size -= chunk;
+    }
+  return true;
+}
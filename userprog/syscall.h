@@ -2,7 +2,24 @@
 #ifndef USERPROG_SYSCALL_H
 #define USERPROG_SYSCALL_H
 
+#include <stdbool.h>
+#include <stddef.h>
+#include "threads/synch.h"
+
+struct file;
+struct thread;
+
 void syscall_init (void);
+void syscall_print_stats (void);
+
+/* Access to user memory, see userprog/syscall.c. */
+bool validate_user_buffer (const void *ubuf, size_t size, bool writable);
+int strncpy_from_user (char *dst, const char *usrc, size_t size);
+
+/* File descriptor tables. */
+struct list_elem* find_fd_element(int fd, struct thread* current_thread);
+int add_file_to_fd_table(struct thread* current_thread, struct file* fp, bool warning);
+
 struct lock read_write_lock;
 struct lock open_close_lock;
 #endif /* userprog/syscall.h */
@@ -0,0 +1,231 @@
+#include "vm/mmap.h"
+#include <debug.h>
+#include <round.h>
+#include <string.h>
+#include "filesys/file.h"
+#include "threads/malloc.h"
+#include "threads/palloc.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "threads/vaddr.h"
+#include "userprog/pagedir.h"
+#include "userprog/syscall.h"
+#include "vm/stack.h"
+
+static struct mmap_region *find_region (struct thread *, const void *upage);
+static void unmap_region (struct thread *, struct mmap_region *);
+static bool fs_lock_acquire (void);
+static void fs_lock_release (bool acquired);
+
+/* Maps FILE into the current process starting at user page
+   ADDR.  The mapping keeps its own reference to the file, so it
+   survives a later close() or remove() of the file.
+   Returns the new mapping's identifier, or MAP_FAILED if ADDR is
+   null or misaligned, the file is empty, or any page of the
+   mapping would overlap a page that is already in use or the
+   region reserved for the stack to grow into. */
+mapid_t
+mmap_map (struct file *file, void *addr)
+{
+  struct thread *t = thread_current ();
+  struct mmap_region *region;
+  off_t length;
+  size_t page_cnt;
+  size_t i;
+  bool acquired;
+
+  if (file == NULL || addr == NULL || pg_ofs (addr) != 0)
+    return MAP_FAILED;
+
+  acquired = fs_lock_acquire ();
+  length = file_length (file);
+  fs_lock_release (acquired);
+  if (length == 0)
+    return MAP_FAILED;
+
+  /* Every page of the region must be free user address space,
+     below the stack's region: a mapping there would take the
+     faults of stack pushes, see page_fault(). */
+  page_cnt = DIV_ROUND_UP (length, PGSIZE);
+  for (i = 0; i < page_cnt; i++)
+    {
+      uint8_t *upage = (uint8_t *) addr + i * PGSIZE;
+      if (upage >= (uint8_t *) PHYS_BASE - STACK_MAX
+          || upage < (uint8_t *) addr
+          || pagedir_get_page (t->pagedir, upage) != NULL
+          || find_region (t, upage) != NULL)
+        return MAP_FAILED;
+    }
+
+  region = malloc (sizeof *region);
+  if (region == NULL)
+    return MAP_FAILED;
+
+  acquired = fs_lock_acquire ();
+  region->file = file_reopen (file);
+  fs_lock_release (acquired);
+  if (region->file == NULL)
+    {
+      free (region);
+      return MAP_FAILED;
+    }
+
+  region->mapid = t->mapid_counter++;
+  region->addr = addr;
+  region->page_cnt = page_cnt;
+  region->length = length;
+  list_push_back (&t->mmap_list, &region->elem);
+  return region->mapid;
+}
+
+/* Removes mapping MAPID from the current process, writing every
+   page that was modified back to the file.
+   Returns false if MAPID does not name a mapping of this
+   process. */
+bool
+mmap_unmap (mapid_t mapid)
+{
+  struct thread *t = thread_current ();
+  struct list_elem *e;
+
+  for (e = list_begin (&t->mmap_list); e != list_end (&t->mmap_list);
+       e = list_next (e))
+    {
+      struct mmap_region *region = list_entry (e, struct mmap_region, elem);
+      if (region->mapid == mapid)
+        {
+          unmap_region (t, region);
+          return true;
+        }
+    }
+  return false;
+}
+
+/* Removes all of the current process's mappings.  Called when
+   the process exits, before its page directory is destroyed. */
+void
+mmap_unmap_all (void)
+{
+  struct thread *t = thread_current ();
+
+  while (!list_empty (&t->mmap_list))
+    {
+      struct list_elem *e = list_front (&t->mmap_list);
+      unmap_region (t, list_entry (e, struct mmap_region, elem));
+    }
+}
+
+/* Brings in the page of a mapped file that contains FAULT_ADDR.
+   Returns true if FAULT_ADDR lies inside one of the current
+   process's mappings and the page was installed, false
+   otherwise. */
+bool
+mmap_fault (void *fault_addr)
+{
+  struct thread *t = thread_current ();
+  void *upage = pg_round_down (fault_addr);
+  struct mmap_region *region;
+  uint8_t *kpage;
+  off_t ofs;
+  size_t read_bytes;
+  bool acquired;
+
+  if (t->pagedir == NULL)
+    return false;
+  region = find_region (t, upage);
+  if (region == NULL || pagedir_get_page (t->pagedir, upage) != NULL)
+    return false;
+
+  /* The last page of a mapping is only partly backed by the
+     file; the rest of it reads as zeros. */
+  ofs = (uint8_t *) upage - (uint8_t *) region->addr;
+  read_bytes = region->length - ofs < PGSIZE ? region->length - ofs : PGSIZE;
+
+  kpage = palloc_get_page (PAL_USER);
+  if (kpage == NULL)
+    return false;
+
+  acquired = fs_lock_acquire ();
+  read_bytes = file_read_at (region->file, kpage, read_bytes, ofs);
+  fs_lock_release (acquired);
+  memset (kpage + read_bytes, 0, PGSIZE - read_bytes);
+
+  if (!pagedir_set_page (t->pagedir, upage, kpage, true))
+    {
+      palloc_free_page (kpage);
+      return false;
+    }
+  return true;
+}
+
+/* Returns T's mapping that contains UPAGE, or a null pointer if
+   there is none. */
+static struct mmap_region *
+find_region (struct thread *t, const void *upage)
+{
+  struct list_elem *e;
+
+  for (e = list_begin (&t->mmap_list); e != list_end (&t->mmap_list);
+       e = list_next (e))
+    {
+      struct mmap_region *region = list_entry (e, struct mmap_region, elem);
+      const uint8_t *start = region->addr;
+      if ((const uint8_t *) upage >= start
+          && (const uint8_t *) upage < start + region->page_cnt * PGSIZE)
+        return region;
+    }
+  return NULL;
+}
+
+/* Writes back the dirty pages of REGION, frees its frames,
+   closes its file and removes it from T's mapping list. */
+static void
+unmap_region (struct thread *t, struct mmap_region *region)
+{
+  bool acquired = fs_lock_acquire ();
+  size_t i;
+
+  for (i = 0; i < region->page_cnt; i++)
+    {
+      uint8_t *upage = (uint8_t *) region->addr + i * PGSIZE;
+      uint8_t *kpage = pagedir_get_page (t->pagedir, upage);
+      off_t ofs = i * PGSIZE;
+
+      if (kpage == NULL)
+        continue;
+      if (pagedir_is_dirty (t->pagedir, upage))
+        {
+          off_t bytes = region->length - ofs < PGSIZE
+                        ? region->length - ofs : PGSIZE;
+          file_write_at (region->file, kpage, bytes, ofs);
+        }
+      pagedir_clear_page (t->pagedir, upage);
+      palloc_free_page (kpage);
+    }
+  file_close (region->file);
+  fs_lock_release (acquired);
+
+  list_remove (&region->elem);
+  free (region);
+}
+
+/* Acquires the file system lock unless the current thread
+   already holds it, which happens when a system call such as
+   read() faults on a mapped page while copying into it.
+   Returns true if the lock was acquired here. */
+static bool
+fs_lock_acquire (void)
+{
+  if (lock_held_by_current_thread (&read_write_lock))
+    return false;
+  lock_acquire (&read_write_lock);
+  return true;
+}
+
+/* Releases the file system lock if fs_lock_acquire() took it. */
+static void
+fs_lock_release (bool acquired)
+{
+  if (acquired)
+    lock_release (&read_write_lock);
+}
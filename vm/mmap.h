@@ -0,0 +1,33 @@
+#ifndef VM_MMAP_H
+#define VM_MMAP_H
+
+#include <list.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "filesys/off_t.h"
+
+struct file;
+
+/* Map region identifier, same meaning as in lib/user/syscall.h. */
+typedef int mapid_t;
+#define MAP_FAILED ((mapid_t) -1)
+
+/* A file mapped into a process's address space.
+   Pages are not read in at mmap() time; each one is brought in
+   from the file by mmap_fault() the first time it is touched. */
+struct mmap_region
+  {
+    struct list_elem elem;              /* Element in thread's mmap_list. */
+    mapid_t mapid;                      /* Identifier returned to user. */
+    struct file *file;                  /* Private reopened file. */
+    void *addr;                         /* First mapped user page. */
+    size_t page_cnt;                    /* Number of mapped pages. */
+    off_t length;                       /* File length at mmap() time. */
+  };
+
+mapid_t mmap_map (struct file *, void *addr);
+bool mmap_unmap (mapid_t);
+void mmap_unmap_all (void);
+bool mmap_fault (void *fault_addr);
+
+#endif /* vm/mmap.h */
@@ -0,0 +1,246 @@
+#include "vm/share.h"
+#include <debug.h>
+#include <hash.h>
+#include <list.h>
+#include <stdio.h>
+#include <string.h>
+#include "filesys/file.h"
+#include "filesys/inode.h"
+#include "threads/malloc.h"
+#include "threads/palloc.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "threads/vaddr.h"
+#include "userprog/pagedir.h"
+#include "userprog/syscall.h"
+
+/* Shared read-only executable pages.
+
+   Every process running the same executable maps the same
+   frame for each page of a non-writable segment.  Frames are
+   found by the executable's inode sector and the page's file
+   offset, and freed when the last process mapping them exits.
+   A running executable cannot be written (see file_deny_write()
+   in load()) and its inode sector cannot be reused while it is
+   open, so a cached frame never goes stale. */
+
+/* A frame holding one page of an executable. */
+struct shared_page
+  {
+    struct hash_elem hash_elem;         /* Element in shared_pages. */
+    block_sector_t sector;              /* Executable's inode sector. */
+    off_t ofs;                          /* Page's offset in the file. */
+    size_t read_bytes;                  /* Bytes read, rest is zeros. */
+    void *kpage;                        /* The frame. */
+    int ref_cnt;                        /* Number of processes mapping it. */
+  };
+
+/* A shared page mapped by one process, see thread's
+   shared_list. */
+struct shared_mapping
+  {
+    struct list_elem elem;              /* Element in shared_list. */
+    void *upage;                        /* User page. */
+    struct shared_page *page;           /* The frame it maps. */
+  };
+
+static struct hash shared_pages;        /* All shared frames. */
+static struct lock share_lock;          /* Protects shared_pages. */
+
+/* Statistics. */
+static unsigned long long share_hits;   /* Pages found already loaded. */
+static unsigned long long share_loads;  /* Pages read from disk. */
+
+static hash_hash_func shared_page_hash;
+static hash_less_func shared_page_less;
+static struct shared_page *lookup (block_sector_t, off_t, size_t);
+static struct shared_page *load_page (struct file *, block_sector_t, off_t,
+                                      size_t);
+static void put_page (struct shared_page *);
+
+/* Initializes the shared page table. */
+void
+share_init (void)
+{
+  hash_init (&shared_pages, shared_page_hash, shared_page_less, NULL);
+  lock_init (&share_lock);
+}
+
+/* Maps the page at offset OFS in executable FILE, with
+   READ_BYTES bytes read from the file and the rest zeroed, read
+   only at user page UPAGE in the current process.  The page is
+   read from disk only if no other process has it loaded.
+   Returns false if memory allocation or the read fails. */
+bool
+share_map_page (struct file *file, off_t ofs, size_t read_bytes, void *upage)
+{
+  struct thread *t = thread_current ();
+  block_sector_t sector = inode_get_inumber (file_get_inode (file));
+  struct shared_mapping *m;
+  struct shared_page *page;
+
+  ASSERT (ofs % PGSIZE == 0);
+  ASSERT (read_bytes <= PGSIZE);
+
+  m = malloc (sizeof *m);
+  if (m == NULL)
+    return false;
+
+  lock_acquire (&share_lock);
+  page = lookup (sector, ofs, read_bytes);
+  if (page != NULL)
+    {
+      page->ref_cnt++;
+      share_hits++;
+    }
+  else
+    {
+      page = load_page (file, sector, ofs, read_bytes);
+      if (page == NULL)
+        goto fail;
+    }
+
+  if (pagedir_get_page (t->pagedir, upage) != NULL
+      || !pagedir_set_page (t->pagedir, upage, page->kpage, false))
+    {
+      put_page (page);
+      goto fail;
+    }
+  lock_release (&share_lock);
+
+  m->upage = upage;
+  m->page = page;
+  list_push_back (&t->shared_list, &m->elem);
+  return true;
+
+ fail:
+  lock_release (&share_lock);
+  free (m);
+  return false;
+}
+
+/* Unmaps every shared page of the current process, freeing the
+   frames no other process maps.  Must be called before the
+   process's page directory is destroyed, which would otherwise
+   free the frames out from under the other processes. */
+void
+share_release_all (void)
+{
+  struct thread *t = thread_current ();
+
+  lock_acquire (&share_lock);
+  while (!list_empty (&t->shared_list))
+    {
+      struct list_elem *e = list_pop_front (&t->shared_list);
+      struct shared_mapping *m = list_entry (e, struct shared_mapping, elem);
+
+      pagedir_clear_page (t->pagedir, m->upage);
+      put_page (m->page);
+      free (m);
+    }
+  lock_release (&share_lock);
+}
+
+/* Prints shared page statistics. */
+void
+share_print_stats (void)
+{
+  printf ("Share: %llu executable pages loaded, %llu shared\n",
+          share_loads, share_hits);
+}
+
+/* Reads the page at OFS in FILE, whose inode is in SECTOR, into
+   a new frame and adds it to shared_pages with one reference.
+   Returns a null pointer on failure.  share_lock must be held. */
+static struct shared_page *
+load_page (struct file *file, block_sector_t sector, off_t ofs,
+           size_t read_bytes)
+{
+  struct shared_page *page;
+  bool acquired;
+  off_t bytes_read;
+
+  page = malloc (sizeof *page);
+  if (page == NULL)
+    return NULL;
+  page->kpage = palloc_get_page (PAL_USER);
+  if (page->kpage == NULL)
+    {
+      free (page);
+      return NULL;
+    }
+
+  acquired = !lock_held_by_current_thread (&read_write_lock);
+  if (acquired)
+    lock_acquire (&read_write_lock);
+  bytes_read = file_read_at (file, page->kpage, read_bytes, ofs);
+  if (acquired)
+    lock_release (&read_write_lock);
+  if (bytes_read != (off_t) read_bytes)
+    {
+      palloc_free_page (page->kpage);
+      free (page);
+      return NULL;
+    }
+  memset ((uint8_t *) page->kpage + read_bytes, 0, PGSIZE - read_bytes);
+
+  page->sector = sector;
+  page->ofs = ofs;
+  page->read_bytes = read_bytes;
+  page->ref_cnt = 1;
+  hash_insert (&shared_pages, &page->hash_elem);
+  share_loads++;
+  return page;
+}
+
+/* Drops a reference to PAGE, freeing it when none are left.
+   share_lock must be held. */
+static void
+put_page (struct shared_page *page)
+{
+  ASSERT (lock_held_by_current_thread (&share_lock));
+  if (--page->ref_cnt == 0)
+    {
+      hash_delete (&shared_pages, &page->hash_elem);
+      palloc_free_page (page->kpage);
+      free (page);
+    }
+}
+
+/* Returns the loaded page for SECTOR, OFS and READ_BYTES, or a
+   null pointer.  share_lock must be held. */
+static struct shared_page *
+lookup (block_sector_t sector, off_t ofs, size_t read_bytes)
+{
+  struct shared_page key;
+  struct hash_elem *e;
+
+  key.sector = sector;
+  key.ofs = ofs;
+  key.read_bytes = read_bytes;
+  e = hash_find (&shared_pages, &key.hash_elem);
+  return e != NULL ? hash_entry (e, struct shared_page, hash_elem) : NULL;
+}
+
+/* Hashes a shared page by its inode sector and file offset. */
+static unsigned
+shared_page_hash (const struct hash_elem *e, void *aux UNUSED)
+{
+  const struct shared_page *p = hash_entry (e, struct shared_page, hash_elem);
+  return hash_int (p->sector) ^ hash_int (p->ofs);
+}
+
+/* Orders shared pages by sector, offset and read size. */
+static bool
+shared_page_less (const struct hash_elem *a_, const struct hash_elem *b_,
+                  void *aux UNUSED)
+{
+  const struct shared_page *a = hash_entry (a_, struct shared_page, hash_elem);
+  const struct shared_page *b = hash_entry (b_, struct shared_page, hash_elem);
+
+  if (a->sector != b->sector)
+    return a->sector < b->sector;
+  if (a->ofs != b->ofs)
+    return a->ofs < b->ofs;
+  return a->read_bytes < b->read_bytes;
+}
@@ -0,0 +1,42 @@
+#include "vm/stack.h"
+#include <stdint.h>
+#include "threads/palloc.h"
+#include "threads/thread.h"
+#include "threads/vaddr.h"
+#include "userprog/pagedir.h"
+
+/* Grows the current process's stack to cover FAULT_ADDR, given
+   that ESP was the user stack pointer at the time of the fault.
+
+   An access is taken to be a stack access if it is no more than
+   32 bytes below ESP, which is as far as the 80x86 PUSHA
+   instruction reaches before it updates the stack pointer, and
+   lies within STACK_MAX bytes of the top of user memory.
+   Returns true if a zeroed page was mapped at FAULT_ADDR, false
+   if the access does not look like stack growth or memory is
+   exhausted. */
+bool
+stack_grow (void *fault_addr, void *esp)
+{
+  struct thread *t = thread_current ();
+  uintptr_t addr = (uintptr_t) fault_addr;
+  void *upage = pg_round_down (fault_addr);
+  uint8_t *kpage;
+
+  if (t->pagedir == NULL || !is_user_vaddr (fault_addr))
+    return false;
+  if (addr < (uintptr_t) PHYS_BASE - STACK_MAX || addr + 32 < (uintptr_t) esp)
+    return false;
+  if (pagedir_get_page (t->pagedir, upage) != NULL)
+    return false;
+
+  kpage = palloc_get_page (PAL_USER | PAL_ZERO);
+  if (kpage == NULL)
+    return false;
+  if (!pagedir_set_page (t->pagedir, upage, kpage, true))
+    {
+      palloc_free_page (kpage);
+      return false;
+    }
+  return true;
+}
@@ -0,0 +1,11 @@
+#ifndef VM_STACK_H
+#define VM_STACK_H
+
+#include <stdbool.h>
+
+/* Maximum size of a user stack. */
+#define STACK_MAX (8 * 1024 * 1024)
+
+bool stack_grow (void *fault_addr, void *esp);
+
+#endif /* vm/stack.h */